@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Turn a binary trace, written by the ascii trace helpers after
+// AsciiTraceHelper::EnableBinaryRecords, into an ascii trace:
+//
+//   ./waf --run "ascii-trace-format --input=lwsn.tr --output=lwsn.txt"
+//
+// The ascii trace is written to the standard output if no output file
+// is given.
+
+#include <fstream>
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "the binary trace", input);
+  cmd.AddValue ("output", "the ascii trace, the standard output if empty", output);
+  cmd.Parse (argc, argv);
+
+  std::ifstream is (input.c_str (), std::ios::in | std::ios::binary);
+  if (!is)
+    {
+      std::cerr << "Unable to open " << input << std::endl;
+      return 1;
+    }
+
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file)
+        {
+          std::cerr << "Unable to open " << output << std::endl;
+          return 1;
+        }
+    }
+  std::ostream &os = output.empty () ? std::cout : file;
+
+  if (!BinaryTraceFile::Format (is, os))
+    {
+      std::cerr << input << " is not a binary trace, or is truncated" << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <limits>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "trace-filter.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceFilter");
+
+TraceFilter::TraceFilter ()
+  : m_minSize (0),
+    m_maxSize (std::numeric_limits<uint32_t>::max ()),
+    m_checkType (false),
+    m_type (LwsnHeader::ORIGINAL_TRANSMISSION),
+    m_maxPerFlow (0),
+    m_sampling (1),
+    m_sampleCount (0),
+    m_passed (0),
+    m_filtered (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TraceFilter::AddDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_devices.push_back (PeekPointer (device));
+}
+
+void
+TraceFilter::AddTimeWindow (Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this << start << stop);
+  m_windows.push_back (std::make_pair (start, stop));
+}
+
+void
+TraceFilter::SetSizeRange (uint32_t minSize, uint32_t maxSize)
+{
+  NS_LOG_FUNCTION (this << minSize << maxSize);
+  m_minSize = minSize;
+  m_maxSize = maxSize;
+}
+
+void
+TraceFilter::SetLwsnType (LwsnHeader::LwsnType type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_checkType = true;
+  m_type = type;
+}
+
+void
+TraceFilter::SetMaxPacketsPerFlow (uint32_t maxPackets)
+{
+  NS_LOG_FUNCTION (this << maxPackets);
+  m_maxPerFlow = maxPackets;
+}
+
+void
+TraceFilter::SetSampling (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_ASSERT (n > 0);
+  m_sampling = n;
+  m_sampleCount = 0;
+}
+
+bool
+TraceFilter::AcceptsDevice (Ptr<const NetDevice> device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  return m_devices.empty ()
+         || std::find (m_devices.begin (), m_devices.end (), PeekPointer (device)) != m_devices.end ();
+}
+
+bool
+TraceFilter::AcceptsSource (Ptr<const Object> object) const
+{
+  NS_LOG_FUNCTION (this << object);
+  Ptr<const NetDevice> device = DynamicCast<const NetDevice> (object);
+  return device == 0 || AcceptsDevice (device);
+}
+
+bool
+TraceFilter::Match (Ptr<const Packet> p)
+{
+  if (!m_windows.empty ())
+    {
+      Time now = Simulator::Now ();
+      bool inWindow = false;
+      for (std::vector<std::pair<Time, Time> >::const_iterator i = m_windows.begin ();
+           i != m_windows.end () && !inWindow; ++i)
+        {
+          inWindow = now >= i->first && now < i->second;
+        }
+      if (!inWindow)
+        {
+          return false;
+        }
+    }
+
+  uint32_t size = p->GetSize ();
+  if (size < m_minSize || size > m_maxSize)
+    {
+      return false;
+    }
+
+  if (!m_checkType && m_maxPerFlow == 0)
+    {
+      return true;
+    }
+  // the header is only read when a predicate needs it
+  LwsnHeader header;
+  if (size < header.GetSerializedSize ())
+    {
+      return false;
+    }
+  p->PeekHeader (header);
+  if (m_checkType && header.GetType () != m_type)
+    {
+      return false;
+    }
+  if (m_maxPerFlow != 0)
+    {
+      uint32_t &count = m_flows[header.GetOsid ()];
+      if (count >= m_maxPerFlow)
+        {
+          return false;
+        }
+      count++;
+    }
+  return true;
+}
+
+bool
+TraceFilter::Pass (Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  bool pass = Match (p);
+  if (pass && m_sampling > 1)
+    {
+      pass = m_sampleCount == 0;
+      m_sampleCount = (m_sampleCount + 1) % m_sampling;
+    }
+  if (pass)
+    {
+      m_passed++;
+    }
+  else
+    {
+      m_filtered++;
+    }
+  return pass;
+}
+
+uint64_t
+TraceFilter::GetNPassed (void) const
+{
+  return m_passed;
+}
+
+uint64_t
+TraceFilter::GetNFiltered (void) const
+{
+  return m_filtered;
+}
+
+} // namespace ns3
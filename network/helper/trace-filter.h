@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_FILTER_H
+#define TRACE_FILTER_H
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/object.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/lwsn-header.h"
+
+namespace ns3 {
+
+/**
+ * \brief Select the packets written by the default trace sinks
+ *
+ * A filter is given to the Hook functions of PcapHelper and
+ * AsciiTraceHelper, and is evaluated on every traced packet before
+ * the packet is formatted or written, so that the tracing of the
+ * discarded packets costs no file I/O.
+ *
+ * A packet is written if it satisfies every predicate set:
+ *  - the packet is traced on one of the devices added (decided once,
+ *    when the tracing of a device is enabled or when a trace source of
+ *    a device is hooked);
+ *  - the current time is in one of the time windows added;
+ *  - the size of the packet is within the size range;
+ *  - the packet starts with an LwsnHeader of the type set;
+ * and if it is selected by the sampling set:
+ *  - only the first packets of every flow, a flow being identified by
+ *    the Osid of the LwsnHeader the packet starts with;
+ *  - one packet in every N of the packets left.
+ *
+ * Nothing is filtered by default. A filter shared by several sinks
+ * counts the packets of all of them.
+ *
+ * The default filters of PcapHelper and AsciiTraceHelper are reset
+ * when the simulator is destroyed.
+ */
+class TraceFilter : public SimpleRefCount<TraceFilter>
+{
+public:
+  TraceFilter ();
+
+  /**
+   * \brief Only trace the devices added.
+   *
+   * The filter does not keep the devices alive: the sinks of a device
+   * hold the filter, so holding the device would make a cycle.
+   *
+   * \param device a device to trace
+   */
+  void AddDevice (Ptr<NetDevice> device);
+  /**
+   * \brief Only trace the packets within the time windows added.
+   *
+   * \param start the start of the window
+   * \param stop the end of the window, excluded
+   */
+  void AddTimeWindow (Time start, Time stop);
+  /**
+   * \brief Only trace the packets whose size is in a range.
+   *
+   * \param minSize the minimum size, in bytes
+   * \param maxSize the maximum size, in bytes
+   */
+  void SetSizeRange (uint32_t minSize, uint32_t maxSize);
+  /**
+   * \brief Only trace the packets starting with an LwsnHeader of a type.
+   *
+   * \param type the LwsnHeader type
+   */
+  void SetLwsnType (LwsnHeader::LwsnType type);
+  /**
+   * \brief Only trace the first packets of each flow.
+   *
+   * \param maxPackets the number of packets traced per flow
+   */
+  void SetMaxPacketsPerFlow (uint32_t maxPackets);
+  /**
+   * \brief Only trace one packet in every n.
+   *
+   * The first packet is traced, then the (n+1)-th, and so on.
+   *
+   * \param n the sampling period, 1 to trace every packet
+   */
+  void SetSampling (uint32_t n);
+
+  /**
+   * \brief Check whether a device is to be traced.
+   *
+   * \param device the device
+   * \returns false if the filter only traces other devices
+   */
+  bool AcceptsDevice (Ptr<const NetDevice> device) const;
+  /**
+   * \brief Check whether the trace sources of an object are to be hooked.
+   *
+   * \param object the object holding the trace sources
+   * \returns false if the object is a device the filter does not trace;
+   * the objects which are not devices, such as queues, are accepted
+   */
+  bool AcceptsSource (Ptr<const Object> object) const;
+  /**
+   * \brief Check whether a packet is to be traced, and count it.
+   *
+   * \param p the packet
+   * \returns true if the packet is to be traced
+   */
+  bool Pass (Ptr<const Packet> p);
+
+  /**
+   * \returns the number of packets traced so far
+   */
+  uint64_t GetNPassed (void) const;
+  /**
+   * \returns the number of packets discarded so far
+   */
+  uint64_t GetNFiltered (void) const;
+
+private:
+  /**
+   * \brief Check the predicates of the filter.
+   *
+   * \param p the packet
+   * \returns true if the packet satisfies every predicate
+   */
+  bool Match (Ptr<const Packet> p);
+
+  std::vector<const NetDevice *> m_devices;     //!< the devices traced, empty for all
+  std::vector<std::pair<Time, Time> > m_windows; //!< the time windows, empty for all times
+  uint32_t m_minSize;                          //!< the minimum packet size
+  uint32_t m_maxSize;                          //!< the maximum packet size
+  bool m_checkType;                            //!< true to check the LwsnHeader type
+  LwsnHeader::LwsnType m_type;                 //!< the LwsnHeader type traced
+  uint32_t m_maxPerFlow;                       //!< the packets traced per flow, 0 for all
+  std::map<uint16_t, uint32_t> m_flows;        //!< the packets traced so far, per Osid
+  uint32_t m_sampling;                         //!< the sampling period
+  uint32_t m_sampleCount;                      //!< the packets matched since the last one traced
+  uint64_t m_passed;                           //!< number of packets traced
+  uint64_t m_filtered;                         //!< number of packets discarded
+};
+
+} // namespace ns3
+
+#endif /* TRACE_FILTER_H */
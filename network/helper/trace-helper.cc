@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <string>
 #include <fstream>
+#include <cstdio>
 
 #include "ns3/abort.h"
 #include "ns3/assert.h"
@@ -28,6 +29,8 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/simulator.h"
 
 #include "trace-helper.h"
 
@@ -35,6 +38,38 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
+/// The pcapng file shared by every pcap file created, 0 if none
+static Ptr<PcapngFile> g_multiplexFile;
+
+/// The filter of the pcap sinks given no filter, 0 if none
+static Ptr<TraceFilter> g_pcapFilter;
+
+/// The filter of the ascii sinks given no filter, 0 if none
+static Ptr<TraceFilter> g_asciiFilter;
+
+/// True if the ascii sinks write binary records
+static bool g_binaryRecords = false;
+
+/// The number of packet bytes kept by the binary records
+static uint32_t g_binarySnapLen = 0;
+
+/// The size of the blocks of the ascii files writer threads, 0 to write synchronously
+static uint32_t g_asyncBlockSize = 0;
+
+/// The number of blocks of the ascii files writer threads
+static uint32_t g_asyncBlockCount = 2;
+
+/**
+ * \param filter a filter, 0 if none
+ * \param nd a device
+ * \returns false if the filter excludes the device from the traces
+ */
+static bool
+IsTraced (Ptr<TraceFilter> filter, Ptr<NetDevice> nd)
+{
+  return filter == 0 || filter->AcceptsDevice (nd);
+}
+
 PcapHelper::PcapHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -56,7 +91,21 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
-  file->Open (filename, filemode);
+  if (g_multiplexFile != 0 && (filemode & std::ios::out))
+    {
+      // the file name of the device becomes the name of its interface
+      std::string name = filename;
+      std::string::size_type dot = name.rfind (".pcap");
+      if (dot != std::string::npos && dot + 5 == name.size ())
+        {
+          name.erase (dot);
+        }
+      file->Open (g_multiplexFile, name);
+    }
+  else
+    {
+      file->Open (filename, filemode);
+    }
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
   file->Init (dataLinkType, snapLen, tzCorrection);
@@ -159,6 +208,57 @@ PcapHelper::GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object
   return oss.str ();
 }
 
+void
+PcapHelper::EnableMultiplexing (std::string filename, uint32_t blockSize, uint32_t blockCount)
+{
+  NS_LOG_FUNCTION (filename << blockSize << blockCount);
+  NS_ABORT_MSG_IF (g_multiplexFile != 0, "PcapHelper::EnableMultiplexing(): already enabled");
+  g_multiplexFile = Create<PcapngFile> ();
+  g_multiplexFile->Open (filename);
+  NS_ABORT_MSG_IF (g_multiplexFile->Fail (), "Unable to Open " << filename);
+  if (blockSize > 0)
+    {
+      g_multiplexFile->EnableAsyncWrite (blockSize, blockCount);
+    }
+  Simulator::ScheduleDestroy (&PcapHelper::DisableMultiplexing);
+}
+
+void
+PcapHelper::DisableMultiplexing (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_multiplexFile != 0)
+    {
+      // the files created so far keep the pcapng file open
+      g_multiplexFile->Flush ();
+      g_multiplexFile = 0;
+    }
+}
+
+void
+PcapHelper::SetDefaultFilter (Ptr<TraceFilter> filter)
+{
+  NS_LOG_FUNCTION (filter);
+  g_pcapFilter = filter;
+  if (filter != 0)
+    {
+      Simulator::ScheduleDestroy (&PcapHelper::ResetDefaultFilter);
+    }
+}
+
+void
+PcapHelper::ResetDefaultFilter (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_pcapFilter = 0;
+}
+
+Ptr<TraceFilter>
+PcapHelper::GetDefaultFilter (void)
+{
+  return g_pcapFilter;
+}
+
 //
 // The basic default trace sink.  This one just writes the packet to the pcap
 // file which is good enough for most kinds of captures.
@@ -177,6 +277,16 @@ PcapHelper::SinkWithHeader (Ptr<PcapFileWrapper> file, const Header &header, Ptr
   file->Write (Simulator::Now (), header, p);
 }
 
+void
+PcapHelper::FilteredSink (Ptr<PcapFileWrapper> file, Ptr<TraceFilter> filter, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << filter << p);
+  if (filter->Pass (p))
+    {
+      file->Write (Simulator::Now (), p);
+    }
+}
+
 AsciiTraceHelper::AsciiTraceHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -192,7 +302,19 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
 {
   NS_LOG_FUNCTION (filename << filemode);
 
+  if (g_binaryRecords)
+    {
+      filemode |= std::ios::binary;
+    }
   Ptr<OutputStreamWrapper> StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+  if (g_asyncBlockSize != 0)
+    {
+      StreamWrapper->EnableAsyncWrite (g_asyncBlockSize, g_asyncBlockCount);
+    }
+  if (g_binaryRecords && !(filemode & std::ios::app))
+    {
+      BinaryTraceFile::WriteHeader (*StreamWrapper->GetStream ());
+    }
 
   //
   // Note that the ascii trace helper promptly forgets all about the trace file.
@@ -397,10 +519,130 @@ AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
+void
+AsciiTraceHelper::SetDefaultFilter (Ptr<TraceFilter> filter)
+{
+  NS_LOG_FUNCTION (filter);
+  g_asciiFilter = filter;
+  if (filter != 0)
+    {
+      Simulator::ScheduleDestroy (&AsciiTraceHelper::ResetDefaultFilter);
+    }
+}
+
+void
+AsciiTraceHelper::ResetDefaultFilter (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_asciiFilter = 0;
+}
+
+Ptr<TraceFilter>
+AsciiTraceHelper::GetDefaultFilter (void)
+{
+  return g_asciiFilter;
+}
+
+void
+AsciiTraceHelper::EnableBinaryRecords (uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (snapLen);
+  NS_ABORT_MSG_IF (snapLen > BinaryTraceFile::MAX_SNAPLEN,
+                   "AsciiTraceHelper::EnableBinaryRecords(): snapLen larger than " << BinaryTraceFile::MAX_SNAPLEN);
+  g_binaryRecords = true;
+  g_binarySnapLen = snapLen;
+  Simulator::ScheduleDestroy (&AsciiTraceHelper::DisableBinaryRecords);
+}
+
+void
+AsciiTraceHelper::DisableBinaryRecords (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_binaryRecords = false;
+  g_binarySnapLen = 0;
+}
+
+void
+AsciiTraceHelper::EnableAsyncWrite (uint32_t blockSize, uint32_t blockCount)
+{
+  NS_LOG_FUNCTION (blockSize << blockCount);
+  NS_ABORT_MSG_IF (blockSize == 0 || blockCount < 2,
+                   "AsciiTraceHelper::EnableAsyncWrite(): at least two blocks of one byte are needed");
+  g_asyncBlockSize = blockSize;
+  g_asyncBlockCount = blockCount;
+}
+
+void
+AsciiTraceHelper::DisableAsyncWrite (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_asyncBlockSize = 0;
+}
+
+bool
+AsciiTraceHelper::IsBinary (void)
+{
+  return g_binaryRecords;
+}
+
+BinaryTraceFile::Source
+AsciiTraceHelper::GetBinarySource (BinaryTraceFile::Event event, const ObjectBase *object)
+{
+  NS_LOG_FUNCTION (event << object);
+  BinaryTraceFile::Source source;
+  source.m_event = event;
+  source.m_node = BinaryTraceFile::NO_ID;
+  source.m_device = BinaryTraceFile::NO_ID;
+  const NetDevice *device = dynamic_cast<const NetDevice *> (object);
+  if (device != 0)
+    {
+      source.m_device = device->GetIfIndex ();
+      if (device->GetNode () != 0)
+        {
+          source.m_node = device->GetNode ()->GetId ();
+        }
+    }
+  return source;
+}
+
+BinaryTraceFile::Source
+AsciiTraceHelper::GetBinarySource (BinaryTraceFile::Event event, std::string context)
+{
+  NS_LOG_FUNCTION (event << context);
+  BinaryTraceFile::Source source;
+  source.m_event = event;
+  source.m_node = BinaryTraceFile::NO_ID;
+  source.m_device = BinaryTraceFile::NO_ID;
+  uint32_t node, device;
+  int fields = std::sscanf (context.c_str (), "/NodeList/%u/DeviceList/%u", &node, &device);
+  if (fields >= 1)
+    {
+      source.m_node = node;
+    }
+  if (fields == 2)
+    {
+      source.m_device = device;
+    }
+  return source;
+}
+
+void
+AsciiTraceHelper::BinarySink (Ptr<OutputStreamWrapper> stream, BinarySinkData data, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (stream << p);
+  if (data.m_filter == 0 || data.m_filter->Pass (p))
+    {
+      BinaryTraceFile::Write (*stream->GetStream (), Simulator::Now (), data.m_source, p, g_binarySnapLen);
+    }
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
-  EnablePcapInternal (prefix, nd, promiscuous, explicitFilename);
+  if (IsTraced (PcapHelper::GetDefaultFilter (), nd))
+    {
+      EnablePcapInternal (prefix, nd, promiscuous, explicitFilename);
+    }
 }
 
 void 
@@ -468,7 +710,10 @@ PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t d
 void 
 AsciiTraceHelperForDevice::EnableAscii (std::string prefix, Ptr<NetDevice> nd, bool explicitFilename)
 {
-  EnableAsciiInternal (Ptr<OutputStreamWrapper> (), prefix, nd, explicitFilename);
+  if (IsTraced (AsciiTraceHelper::GetDefaultFilter (), nd))
+    {
+      EnableAsciiInternal (Ptr<OutputStreamWrapper> (), prefix, nd, explicitFilename);
+    }
 }
 
 //
@@ -477,7 +722,10 @@ AsciiTraceHelperForDevice::EnableAscii (std::string prefix, Ptr<NetDevice> nd, b
 void 
 AsciiTraceHelperForDevice::EnableAscii (Ptr<OutputStreamWrapper> stream, Ptr<NetDevice> nd)
 {
-  EnableAsciiInternal (stream, std::string (), nd, false);
+  if (IsTraced (AsciiTraceHelper::GetDefaultFilter (), nd))
+    {
+      EnableAsciiInternal (stream, std::string (), nd, false);
+    }
 }
 
 //
@@ -509,7 +757,10 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
   bool explicitFilename)
 {
   Ptr<NetDevice> nd = Names::Find<NetDevice> (ndName);
-  EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+  if (IsTraced (AsciiTraceHelper::GetDefaultFilter (), nd))
+    {
+      EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+    }
 }
 
 //
@@ -539,7 +790,10 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std
   for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
     {
       Ptr<NetDevice> dev = *i;
-      EnableAsciiInternal (stream, prefix, dev, false);
+      if (IsTraced (AsciiTraceHelper::GetDefaultFilter (), dev))
+        {
+          EnableAsciiInternal (stream, prefix, dev, false);
+        }
     }
 }
 
@@ -645,7 +899,10 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
 
       Ptr<NetDevice> nd = node->GetDevice (deviceid);
 
-      EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+      if (IsTraced (AsciiTraceHelper::GetDefaultFilter (), nd))
+        {
+          EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+        }
       return;
     }
 }
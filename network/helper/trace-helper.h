@@ -25,6 +25,8 @@
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/trace-filter.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -115,8 +117,59 @@ public:
    * @param object object
    * @param traceName trace source name
    * @param file file wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
-  template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
+  template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file,
+                                              Ptr<TraceFilter> filter = 0);
+
+  /**
+   * @brief Write every pcap file created from now on into a single pcapng file.
+   *
+   * Instead of opening a file of its own, each file created for writing
+   * by CreateFile becomes an interface of the pcapng file, named after
+   * the file name (without its ".pcap" suffix), and its packets are
+   * written to that file in order.  This keeps a single file descriptor
+   * and a single buffer whatever the number of devices traced.  The
+   * pcapng file is flushed, and multiplexing disabled, at
+   * Simulator::Destroy.
+   *
+   * @param filename name of the pcapng file
+   * @param blockSize size of the blocks written by a background thread,
+   *        0 to write synchronously (see PcapFile::EnableAsyncWrite)
+   * @param blockCount maximum number of blocks kept in memory
+   */
+  static void EnableMultiplexing (std::string filename, uint32_t blockSize = 0, uint32_t blockCount = 4);
+
+  /**
+   * @brief Stop writing the pcap files created from now on into the pcapng file.
+   *
+   * The pcapng file is flushed, and closed once the files already
+   * created have been destroyed.
+   */
+  static void DisableMultiplexing (void);
+
+  /**
+   * @brief Filter the packets written by the default sinks hooked from now on.
+   *
+   * The filter is used by the Hook functions given no filter of their
+   * own, and is also checked by PcapHelperForDevice before enabling the
+   * tracing of a device. It is reset when the simulator is destroyed.
+   *
+   * @param filter the filter, 0 to write every packet
+   */
+  static void SetDefaultFilter (Ptr<TraceFilter> filter);
+
+  /**
+   * @returns the default filter, 0 if none
+   */
+  static Ptr<TraceFilter> GetDefaultFilter (void);
+
+  /**
+   * @brief Stop filtering the packets written by the default sinks.
+   *
+   * Called when the simulator is destroyed.
+   */
+  static void ResetDefaultFilter (void);
 
 private:
   /**
@@ -141,13 +194,33 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  /**
+   * The default trace sink, writing only the packets passing a filter.
+   *
+   * @param file the file to write to
+   * @param filter the filter
+   * @param p the packet to write
+   */
+  static void FilteredSink (Ptr<PcapFileWrapper> file, Ptr<TraceFilter> filter, Ptr<const Packet> p);
 };
 
 template <typename T> void
-PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapFileWrapper> file)
+PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapFileWrapper> file,
+                             Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnectWithoutContext (tracename.c_str (), MakeBoundCallback (&DefaultSink, file));
+  if (filter == 0)
+    {
+      filter = GetDefaultFilter ();
+    }
+  if (filter != 0 && !filter->AcceptsSource (object))
+    {
+      // every packet of this device would be discarded
+      return;
+    }
+  bool result = filter == 0
+    ? object->TraceConnectWithoutContext (tracename.c_str (), MakeBoundCallback (&DefaultSink, file))
+    : object->TraceConnectWithoutContext (tracename.c_str (), MakeBoundCallback (&FilteredSink, file, filter));
   NS_ASSERT_MSG (result == true, "PcapHelper::HookDefaultSink():  Unable to hook \"" << tracename << "\"");
 }
 
@@ -229,9 +302,11 @@ public:
    * @param object object
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
-  void HookDefaultEnqueueSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream);
+  void HookDefaultEnqueueSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                             Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
@@ -241,10 +316,12 @@ public:
    * @param context context string
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
   void HookDefaultEnqueueSinkWithContext (Ptr<T> object, 
-                                          std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream);
+                                          std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                          Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default drop operation trace sink that 
@@ -253,9 +330,11 @@ public:
    * @param object object
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
-  void HookDefaultDropSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream);
+  void HookDefaultDropSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                          Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default drop operation trace sink that 
@@ -265,10 +344,12 @@ public:
    * @param context context string
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
   void HookDefaultDropSinkWithContext (Ptr<T> object, 
-                                       std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream);
+                                       std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                       Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default dequeue operation trace sink
@@ -277,9 +358,11 @@ public:
    * @param object object
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
-  void HookDefaultDequeueSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream);
+  void HookDefaultDequeueSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                             Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default dequeue operation trace sink
@@ -289,10 +372,12 @@ public:
    * @param context context string
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
   void HookDefaultDequeueSinkWithContext (Ptr<T> object, 
-                                          std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream);
+                                          std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                          Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default receive operation trace sink
@@ -301,9 +386,11 @@ public:
    * @param object object
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
-  void HookDefaultReceiveSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream);
+  void HookDefaultReceiveSinkWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                             Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Hook a trace source to the default receive operation trace sink
@@ -313,10 +400,12 @@ public:
    * @param context context string
    * @param traceName trace source name
    * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
    */
   template <typename T> 
   void HookDefaultReceiveSinkWithContext (Ptr<T> object, 
-                                          std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream);
+                                          std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                          Ptr<TraceFilter> filter = 0);
 
   /**
    * @brief Basic Enqueue default trace sink.
@@ -455,13 +544,248 @@ public:
    * @param p the packet
    */
   static void DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> file, std::string context, Ptr<const Packet> p);
+
+  /**
+   * @brief Filter the packets written by the default sinks hooked from now on.
+   *
+   * @see PcapHelper::SetDefaultFilter
+   *
+   * @param filter the filter, 0 to write every packet
+   */
+  static void SetDefaultFilter (Ptr<TraceFilter> filter);
+
+  /**
+   * @returns the default filter, 0 if none
+   */
+  static Ptr<TraceFilter> GetDefaultFilter (void);
+
+  /**
+   * @brief Stop filtering the packets written by the default sinks.
+   *
+   * Called when the simulator is destroyed.
+   */
+  static void ResetDefaultFilter (void);
+
+  /**
+   * @brief Write binary records instead of text to the files created from now on.
+   *
+   * The files created by CreateFileStream become binary traces (see
+   * BinaryTraceFile), and the default sinks hooked from now on write
+   * a record per event instead of formatting the context and the
+   * packet.  The node and the device of a record are taken from the
+   * context string given to the Hook functions with a context, or
+   * from the object hooked when it is a NetDevice.  Streams given to
+   * the Hook functions must then have been created by
+   * CreateFileStream.  The ascii-trace-format program turns the
+   * records into text.  Text is written again once the simulator is
+   * destroyed.
+   *
+   * @param snapLen number of bytes of each packet to keep, at most
+   *        BinaryTraceFile::MAX_SNAPLEN
+   */
+  static void EnableBinaryRecords (uint32_t snapLen = 32);
+
+  /**
+   * @brief Write text to the files created and hooked from now on.
+   */
+  static void DisableBinaryRecords (void);
+
+  /**
+   * @brief Write the files created from now on from a background thread.
+   *
+   * @see OutputStreamWrapper::EnableAsyncWrite
+   *
+   * @param blockSize size of the blocks written by the background thread
+   * @param blockCount number of blocks of each file; 2 to fill one while
+   *        the other is written
+   */
+  static void EnableAsyncWrite (uint32_t blockSize = 65536, uint32_t blockCount = 2);
+
+  /**
+   * @brief Write the files created from now on synchronously.
+   */
+  static void DisableAsyncWrite (void);
+
+private:
+  /**
+   * @brief The state bound to a binary trace sink
+   */
+  struct BinarySinkData
+  {
+    Ptr<TraceFilter> m_filter;           //!< the filter, 0 if none
+    BinaryTraceFile::Source m_source;    //!< the source of the events
+  };
+
+  /**
+   * @brief The default trace sink when binary records are enabled.
+   *
+   * @param file the output file
+   * @param data the filter and the source of the events
+   * @param p the packet
+   */
+  static void BinarySink (Ptr<OutputStreamWrapper> file, BinarySinkData data, Ptr<const Packet> p);
+
+  /**
+   * @returns true if the default sinks write binary records
+   */
+  static bool IsBinary (void);
+
+  /**
+   * @brief Identify the source of the events of a trace source.
+   *
+   * @param event the kind of events
+   * @param object the object owning the trace source
+   * @returns the source, with the node and the device of object if it is a NetDevice
+   */
+  static BinaryTraceFile::Source GetBinarySource (BinaryTraceFile::Event event, const ObjectBase *object);
+
+  /**
+   * @brief Identify the source of the events of a trace source.
+   *
+   * @param event the kind of events
+   * @param context the context string, starting with /NodeList/n/DeviceList/d
+   * @returns the source, with the node and the device of the context if any
+   */
+  static BinaryTraceFile::Source GetBinarySource (BinaryTraceFile::Event event, std::string context);
+
+  /**
+   * @brief A default trace sink writing only the packets passing a filter.
+   *
+   * The filter is evaluated before the packet is formatted.
+   *
+   * @param file the output file
+   * @param filter the filter
+   * @param p the packet
+   */
+  template <void (*Sink)(Ptr<OutputStreamWrapper>, Ptr<const Packet>)>
+  static void FilteredSinkWithoutContext (Ptr<OutputStreamWrapper> file, Ptr<TraceFilter> filter, Ptr<const Packet> p);
+
+  /**
+   * @brief A default trace sink writing only the packets passing a filter.
+   *
+   * @param file the output file
+   * @param filter the filter
+   * @param context the context
+   * @param p the packet
+   */
+  template <void (*Sink)(Ptr<OutputStreamWrapper>, std::string, Ptr<const Packet>)>
+  static void FilteredSinkWithContext (Ptr<OutputStreamWrapper> file, Ptr<TraceFilter> filter,
+                                       std::string context, Ptr<const Packet> p);
+
+  /**
+   * @brief Hook a trace source to a default sink, through a filter if any.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
+   * @param event the kind of events, for binary records
+   * @returns false if the trace source could not be hooked; the trace
+   * sources of a device the filter does not trace are left unhooked
+   */
+  template <void (*Sink)(Ptr<OutputStreamWrapper>, Ptr<const Packet>), typename T>
+  static bool HookWithoutContext (Ptr<T> object, std::string traceName, Ptr<OutputStreamWrapper> stream,
+                                  Ptr<TraceFilter> filter, BinaryTraceFile::Event event);
+
+  /**
+   * @brief Hook a trace source to a default sink, through a filter if any.
+   *
+   * @param object object
+   * @param context context string
+   * @param traceName trace source name
+   * @param stream output stream wrapper
+   * @param filter the packets to write, 0 for the default filter
+   * @param event the kind of events, for binary records
+   * @returns false if the trace source could not be hooked; the trace
+   * sources of a device the filter does not trace are left unhooked
+   */
+  template <void (*Sink)(Ptr<OutputStreamWrapper>, std::string, Ptr<const Packet>), typename T>
+  static bool HookWithContext (Ptr<T> object, std::string context, std::string traceName,
+                               Ptr<OutputStreamWrapper> stream, Ptr<TraceFilter> filter,
+                               BinaryTraceFile::Event event);
 };
 
+template <void (*Sink)(Ptr<OutputStreamWrapper>, Ptr<const Packet>)> void
+AsciiTraceHelper::FilteredSinkWithoutContext (Ptr<OutputStreamWrapper> file, Ptr<TraceFilter> filter, Ptr<const Packet> p)
+{
+  if (filter->Pass (p))
+    {
+      Sink (file, p);
+    }
+}
+
+template <void (*Sink)(Ptr<OutputStreamWrapper>, std::string, Ptr<const Packet>)> void
+AsciiTraceHelper::FilteredSinkWithContext (Ptr<OutputStreamWrapper> file, Ptr<TraceFilter> filter,
+                                           std::string context, Ptr<const Packet> p)
+{
+  if (filter->Pass (p))
+    {
+      Sink (file, context, p);
+    }
+}
+
+template <void (*Sink)(Ptr<OutputStreamWrapper>, Ptr<const Packet>), typename T> bool
+AsciiTraceHelper::HookWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file,
+                                      Ptr<TraceFilter> filter, BinaryTraceFile::Event event)
+{
+  if (filter == 0)
+    {
+      filter = GetDefaultFilter ();
+    }
+  if (filter != 0 && !filter->AcceptsSource (object))
+    {
+      // every packet of this device would be discarded
+      return true;
+    }
+  if (IsBinary ())
+    {
+      BinarySinkData data;
+      data.m_filter = filter;
+      data.m_source = GetBinarySource (event, PeekPointer (object));
+      return object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&BinarySink, file, data));
+    }
+  if (filter == 0)
+    {
+      return object->TraceConnectWithoutContext (tracename, MakeBoundCallback (Sink, file));
+    }
+  return object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&FilteredSinkWithoutContext<Sink>, file, filter));
+}
+
+template <void (*Sink)(Ptr<OutputStreamWrapper>, std::string, Ptr<const Packet>), typename T> bool
+AsciiTraceHelper::HookWithContext (Ptr<T> object, std::string context, std::string tracename,
+                                   Ptr<OutputStreamWrapper> stream, Ptr<TraceFilter> filter,
+                                   BinaryTraceFile::Event event)
+{
+  if (filter == 0)
+    {
+      filter = GetDefaultFilter ();
+    }
+  if (filter != 0 && !filter->AcceptsSource (object))
+    {
+      // every packet of this device would be discarded
+      return true;
+    }
+  if (IsBinary ())
+    {
+      // the context is only used to identify the node and the device, once
+      BinarySinkData data;
+      data.m_filter = filter;
+      data.m_source = GetBinarySource (event, context);
+      return object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&BinarySink, stream, data));
+    }
+  if (filter == 0)
+    {
+      return object->TraceConnect (tracename, context, MakeBoundCallback (Sink, stream));
+    }
+  return object->TraceConnect (tracename, context, MakeBoundCallback (&FilteredSinkWithContext<Sink>, stream, filter));
+}
+
 template <typename T> void
-AsciiTraceHelper::HookDefaultEnqueueSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file)
+AsciiTraceHelper::HookDefaultEnqueueSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file,
+                                                        Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultEnqueueSinkWithoutContext, file));
+  bool result = HookWithoutContext<&DefaultEnqueueSinkWithoutContext> (object, tracename, file, filter,
+                                                                       BinaryTraceFile::ENQUEUE);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultEnqueueSinkWithoutContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
@@ -471,19 +795,21 @@ AsciiTraceHelper::HookDefaultEnqueueSinkWithContext (
   Ptr<T> object, 
   std::string context, 
   std::string tracename, 
-  Ptr<OutputStreamWrapper> stream)
+  Ptr<OutputStreamWrapper> stream,
+  Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnect (tracename, context, MakeBoundCallback (&DefaultEnqueueSinkWithContext, stream));
+  bool result = HookWithContext<&DefaultEnqueueSinkWithContext> (object, context, tracename, stream, filter,
+                                                                 BinaryTraceFile::ENQUEUE);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultEnqueueSinkWithContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
 
 template <typename T> void
-AsciiTraceHelper::HookDefaultDropSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file)
+AsciiTraceHelper::HookDefaultDropSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file,
+                                                     Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultDropSinkWithoutContext, file));
+  bool result = HookWithoutContext<&DefaultDropSinkWithoutContext> (object, tracename, file, filter,
+                                                                    BinaryTraceFile::DROP);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultDropSinkWithoutContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
@@ -493,19 +819,21 @@ AsciiTraceHelper::HookDefaultDropSinkWithContext (
   Ptr<T> object, 
   std::string context,
   std::string tracename, 
-  Ptr<OutputStreamWrapper> stream)
+  Ptr<OutputStreamWrapper> stream,
+  Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnect (tracename, context, MakeBoundCallback (&DefaultDropSinkWithContext, stream));
+  bool result = HookWithContext<&DefaultDropSinkWithContext> (object, context, tracename, stream, filter,
+                                                              BinaryTraceFile::DROP);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultDropSinkWithContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
 
 template <typename T> void
-AsciiTraceHelper::HookDefaultDequeueSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file)
+AsciiTraceHelper::HookDefaultDequeueSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file,
+                                                        Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultDequeueSinkWithoutContext, file));
+  bool result = HookWithoutContext<&DefaultDequeueSinkWithoutContext> (object, tracename, file, filter,
+                                                                       BinaryTraceFile::DEQUEUE);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultDequeueSinkWithoutContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
@@ -515,19 +843,21 @@ AsciiTraceHelper::HookDefaultDequeueSinkWithContext (
   Ptr<T> object, 
   std::string context,
   std::string tracename, 
-  Ptr<OutputStreamWrapper> stream)
+  Ptr<OutputStreamWrapper> stream,
+  Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnect (tracename, context, MakeBoundCallback (&DefaultDequeueSinkWithContext, stream));
+  bool result = HookWithContext<&DefaultDequeueSinkWithContext> (object, context, tracename, stream, filter,
+                                                                 BinaryTraceFile::DEQUEUE);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultDequeueSinkWithContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
 
 template <typename T> void
-AsciiTraceHelper::HookDefaultReceiveSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file)
+AsciiTraceHelper::HookDefaultReceiveSinkWithoutContext (Ptr<T> object, std::string tracename, Ptr<OutputStreamWrapper> file,
+                                                        Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnectWithoutContext (tracename, MakeBoundCallback (&DefaultReceiveSinkWithoutContext, file));
+  bool result = HookWithoutContext<&DefaultReceiveSinkWithoutContext> (object, tracename, file, filter,
+                                                                       BinaryTraceFile::RECEIVE);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultReceiveSinkWithoutContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
@@ -537,10 +867,11 @@ AsciiTraceHelper::HookDefaultReceiveSinkWithContext (
   Ptr<T> object, 
   std::string context,
   std::string tracename, 
-  Ptr<OutputStreamWrapper> stream)
+  Ptr<OutputStreamWrapper> stream,
+  Ptr<TraceFilter> filter)
 {
-  bool result =
-    object->TraceConnect (tracename, context, MakeBoundCallback (&DefaultReceiveSinkWithContext, stream));
+  bool result = HookWithContext<&DefaultReceiveSinkWithContext> (object, context, tracename, stream, filter,
+                                                                 BinaryTraceFile::RECEIVE);
   NS_ASSERT_MSG (result == true, "AsciiTraceHelper::HookDefaultReceiveSinkWithContext():  Unable to hook \"" 
                  << tracename << "\"");
 }
@@ -21,6 +21,11 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define BUFFER_CHECKSUM_SIMD 1
+#include <immintrin.h>
+#endif
+
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
                 ", zero end="<<m_zeroAreaEnd<<", count="<<m_data->m_count<<", size="<<m_data->m_size<<   \
@@ -43,6 +48,162 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief Sum the 16-bit little-endian words of a span of bytes.
+ *
+ * An odd trailing byte is added as the low byte of a last word.
+ * This is the portable version of the one's-complement sum kernel.
+ *
+ * \param data the start of the span
+ * \param len the length of the span
+ * \returns the sum of the words, without carry folding
+ */
+static uint64_t
+ChecksumSumScalar (const uint8_t *data, uint32_t len)
+{
+  uint64_t sum = 0;
+  uint32_t i = 0;
+  for (; i + 1 < len; i += 2)
+    {
+      sum += data[i] | (data[i + 1] << 8);
+    }
+  if (i < len)
+    {
+      sum += data[i];
+    }
+  return sum;
+}
+
+#ifdef BUFFER_CHECKSUM_SIMD
+
+/**
+ * \ingroup packet
+ * \brief Sum the 16-bit little-endian words of a span of bytes with SSE2.
+ *
+ * \param data the start of the span
+ * \param len the length of the span
+ * \returns the sum of the words, without carry folding
+ */
+__attribute__ ((target ("sse2")))
+static uint64_t
+ChecksumSumSse2 (const uint8_t *data, uint32_t len)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  uint64_t sum = 0;
+  uint32_t i = 0;
+  while (i + 16 <= len)
+    {
+      // each 32-bit lane gets at most 8192 words per round: no overflow
+      __m128i acc = _mm_setzero_si128 ();
+      uint32_t end = std::min (len & ~15U, i + 65536);
+      for (; i < end; i += 16)
+        {
+          __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + i));
+          acc = _mm_add_epi32 (acc, _mm_unpacklo_epi16 (v, zero));
+          acc = _mm_add_epi32 (acc, _mm_unpackhi_epi16 (v, zero));
+        }
+      uint32_t lanes[4];
+      _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes), acc);
+      sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+  return sum + ChecksumSumScalar (data + i, len - i);
+}
+
+/**
+ * \ingroup packet
+ * \brief Sum the 16-bit little-endian words of a span of bytes with AVX2.
+ *
+ * \param data the start of the span
+ * \param len the length of the span
+ * \returns the sum of the words, without carry folding
+ */
+__attribute__ ((target ("avx2")))
+static uint64_t
+ChecksumSumAvx2 (const uint8_t *data, uint32_t len)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  uint64_t sum = 0;
+  uint32_t i = 0;
+  while (i + 32 <= len)
+    {
+      // each 32-bit lane gets at most 8192 words per round: no overflow
+      __m256i acc = _mm256_setzero_si256 ();
+      uint32_t end = std::min (len & ~31U, i + 131072);
+      for (; i < end; i += 32)
+        {
+          __m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data + i));
+          acc = _mm256_add_epi32 (acc, _mm256_unpacklo_epi16 (v, zero));
+          acc = _mm256_add_epi32 (acc, _mm256_unpackhi_epi16 (v, zero));
+        }
+      uint32_t lanes[8];
+      _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), acc);
+      for (uint32_t j = 0; j < 8; j++)
+        {
+          sum += lanes[j];
+        }
+    }
+  return sum + ChecksumSumSse2 (data + i, len - i);
+}
+#endif /* BUFFER_CHECKSUM_SIMD */
+
+/// Signature of the one's-complement sum kernels
+typedef uint64_t (*ChecksumSumFunction)(const uint8_t *data, uint32_t len);
+
+/**
+ * \ingroup packet
+ * \brief Select the fastest one's-complement sum kernel for this CPU.
+ * \returns the kernel
+ */
+static ChecksumSumFunction
+ChecksumSelect (void)
+{
+#ifdef BUFFER_CHECKSUM_SIMD
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      return &ChecksumSumAvx2;
+    }
+  if (__builtin_cpu_supports ("sse2"))
+    {
+      return &ChecksumSumSse2;
+    }
+#endif /* BUFFER_CHECKSUM_SIMD */
+  return &ChecksumSumScalar;
+}
+
+/**
+ * \ingroup packet
+ * \brief Sum the 16-bit little-endian words of a span of bytes with
+ * the kernel selected for this CPU.
+ *
+ * \param data the start of the span
+ * \param len the length of the span
+ * \returns the sum of the words, without carry folding
+ */
+static uint64_t
+ChecksumSum (const uint8_t *data, uint32_t len)
+{
+  static const ChecksumSumFunction sum = ChecksumSelect ();
+  return sum (data, len);
+}
+
+/**
+ * \ingroup packet
+ * \brief Fold a sum of 16-bit words into a 16-bit one's-complement sum.
+ * \param sum the sum to fold
+ * \returns the folded sum
+ */
+static uint16_t
+ChecksumFold (uint64_t sum)
+{
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return static_cast<uint16_t> (sum);
+}
+
 }
 
 namespace ns3 {
@@ -50,7 +211,76 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+NS_THREAD_LOCAL uint32_t Buffer::g_recommendedStart = 0;
+const uint32_t Buffer::FREE_LIST_CLASSES;
+const uint32_t Buffer::FREE_LIST_MIN_SIZE;
+uint32_t Buffer::g_freeListCap[Buffer::FREE_LIST_CLASSES] = {
+  1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000
+};
+NS_THREAD_LOCAL uint64_t Buffer::g_freeListHits = 0;
+NS_THREAD_LOCAL uint64_t Buffer::g_freeListMisses = 0;
+NS_THREAD_LOCAL uint64_t Buffer::g_freeListBytes = 0;
+NS_THREAD_LOCAL uint64_t Buffer::g_headroomMisses = 0;
+
+uint32_t
+Buffer::GetSizeClass (uint32_t size)
+{
+  uint32_t sizeClass = 0;
+  uint32_t classSize = FREE_LIST_MIN_SIZE;
+  while (classSize < size && sizeClass < FREE_LIST_CLASSES)
+    {
+      classSize <<= 1;
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+void
+Buffer::SetFreeListCap (uint32_t size, uint32_t cap)
+{
+  NS_LOG_FUNCTION (size << cap);
+  uint32_t sizeClass = GetSizeClass (size);
+  NS_ASSERT_MSG (sizeClass < FREE_LIST_CLASSES, "Blocks of " << size << " bytes are never recycled");
+  g_freeListCap[sizeClass] = cap;
+}
+
+uint32_t
+Buffer::GetFreeListCap (uint32_t size)
+{
+  uint32_t sizeClass = GetSizeClass (size);
+  if (sizeClass >= FREE_LIST_CLASSES)
+    {
+      return 0;
+    }
+  return g_freeListCap[sizeClass];
+}
+
+uint64_t
+Buffer::GetFreeListHits (void)
+{
+  return g_freeListHits;
+}
+
+uint64_t
+Buffer::GetFreeListMisses (void)
+{
+  return g_freeListMisses;
+}
+
+uint64_t
+Buffer::GetFreeListBytes (void)
+{
+  return g_freeListBytes;
+}
+
+void
+Buffer::ResetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_freeListHits = 0;
+  g_freeListMisses = 0;
+}
+
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -75,22 +305,26 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+NS_THREAD_LOCAL Buffer::FreeList *Buffer::g_freeList = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
   if (IS_INITIALIZED (g_freeList))
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      for (uint32_t sizeClass = 0; sizeClass < FREE_LIST_CLASSES; sizeClass++)
         {
-          Buffer::Deallocate (*i);
+          Buffer::FreeList &list = g_freeList[sizeClass];
+          for (Buffer::FreeList::iterator i = list.begin ();
+               i != list.end (); i++)
+            {
+              Buffer::Deallocate (*i);
+            }
         }
-      delete g_freeList;
+      delete [] g_freeList;
       g_freeList = DESTROYED;
+      g_freeListBytes = 0;
     }
 }
 
@@ -100,18 +334,21 @@ Buffer::Recycle (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
+  uint32_t sizeClass = GetSizeClass (data->m_size);
+  /* feed into the free list of the size class, if the block 
+   * was allocated for it and there is room left. */
+  if (sizeClass >= FREE_LIST_CLASSES ||
+      (FREE_LIST_MIN_SIZE << sizeClass) != data->m_size ||
       IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+      g_freeList[sizeClass].size () >= g_freeListCap[sizeClass])
     {
       Buffer::Deallocate (data);
     }
   else
     {
       NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      g_freeList[sizeClass].push_back (data);
+      g_freeListBytes += data->m_size;
     }
 }
 
@@ -119,26 +356,32 @@ Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
+  uint32_t sizeClass = GetSizeClass (dataSize);
+  if (sizeClass >= FREE_LIST_CLASSES)
+    {
+      /* too large to be recycled */
+      g_freeListMisses++;
+      return Buffer::Allocate (dataSize);
+    }
+  /* try to find a buffer of the size class. */
   if (IS_UNINITIALIZED (g_freeList))
     {
-      g_freeList = new Buffer::FreeList ();
+      g_freeList = new Buffer::FreeList [FREE_LIST_CLASSES];
+      // construct the destructor of this thread, which frees the list
+      // when the thread exits
+      static_cast<void> (&g_localStaticDestructor);
     }
-  else if (IS_INITIALIZED (g_freeList))
+  else if (IS_INITIALIZED (g_freeList) && !g_freeList[sizeClass].empty ())
     {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      struct Buffer::Data *data = g_freeList[sizeClass].back ();
+      g_freeList[sizeClass].pop_back ();
+      g_freeListBytes -= data->m_size;
+      g_freeListHits++;
+      data->m_count = 1;
+      return data;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  g_freeListMisses++;
+  struct Buffer::Data *data = Buffer::Allocate (FREE_LIST_MIN_SIZE << sizeClass);
   NS_ASSERT (data->m_count == 1);
   return data;
 }
@@ -155,6 +398,7 @@ Buffer::Data *
 Buffer::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
+  g_freeListMisses++;
   return Allocate (size);
 }
 #endif /* BUFFER_FREE_LIST */
@@ -206,6 +450,13 @@ Buffer::Buffer (uint32_t dataSize, bool initialize)
     }
 }
 
+Buffer::Buffer (uint32_t dataSize, bool initialize, uint32_t headroom)
+{
+  NS_LOG_FUNCTION (this << dataSize << initialize << headroom);
+  NS_ASSERT (initialize);
+  Initialize (dataSize, headroom);
+}
+
 bool
 Buffer::CheckInternalState (void) const
 {
@@ -244,8 +495,15 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
-  m_start = std::min (m_data->m_size, g_recommendedStart);
+  Initialize (zeroSize, g_recommendedStart);
+}
+
+void
+Buffer::Initialize (uint32_t zeroSize, uint32_t headroom)
+{
+  NS_LOG_FUNCTION (this << zeroSize << headroom);
+  m_data = Buffer::Create (headroom);
+  m_start = std::min (m_data->m_size, headroom);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
   m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
@@ -325,31 +583,75 @@ Buffer::AddAtStart (uint32_t start)
     } 
   else
     {
-      uint32_t newSize = GetInternalSize () + start;
-      struct Buffer::Data *newData = Buffer::Create (newSize);
-      memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (m_start < start)
         {
-          Buffer::Recycle (m_data);
+          g_headroomMisses++;
         }
-      m_data = newData;
-
-      int32_t delta = start - m_start;
-      m_start += delta;
-      m_zeroAreaStart += delta;
-      m_zeroAreaEnd += delta;
-      m_end += delta;
+      Reallocate (start);
       m_start -= start;
 
       // update dirty area
       m_data->m_dirtyStart = m_start;
-      m_data->m_dirtyEnd = m_end;
     }
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("add start=" << start << ", ");
   NS_ASSERT (CheckInternalState ());
 }
+
+void
+Buffer::Reallocate (uint32_t headroom)
+{
+  NS_LOG_FUNCTION (this << headroom);
+  uint32_t newSize = GetInternalSize () + headroom;
+  struct Buffer::Data *newData = Buffer::Create (newSize);
+  memcpy (newData->m_data + headroom, m_data->m_data + m_start, GetInternalSize ());
+  m_data->m_count--;
+  if (m_data->m_count == 0)
+    {
+      Buffer::Recycle (m_data);
+    }
+  m_data = newData;
+
+  int32_t delta = headroom - m_start;
+  m_start += delta;
+  m_zeroAreaStart += delta;
+  m_zeroAreaEnd += delta;
+  m_end += delta;
+
+  // update dirty area
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
+}
+
+void
+Buffer::ReserveHeadroom (uint32_t headroom)
+{
+  NS_LOG_FUNCTION (this << headroom);
+  NS_ASSERT (CheckInternalState ());
+  bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+  if (m_start >= headroom && !isDirty)
+    {
+      return;
+    }
+  Reallocate (std::max (headroom, m_start));
+  m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+  LOG_INTERNAL_STATE ("reserve start=" << headroom << ", ");
+  NS_ASSERT (CheckInternalState ());
+}
+
+uint64_t
+Buffer::GetHeadroomMisses (void)
+{
+  return g_headroomMisses;
+}
+
+void
+Buffer::ResetHeadroomMisses (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_headroomMisses = 0;
+}
+
 void
 Buffer::AddAtEnd (uint32_t end)
 {
@@ -1123,9 +1425,29 @@ void
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  for (uint32_t i = 0; i < size; i++)
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  if (m_current < m_zeroStart)
     {
-      buffer[i] = ReadU8 ();
+      uint32_t toCopy = std::min (size, m_zeroStart - m_current);
+      memcpy (buffer, &m_data[m_current], toCopy);
+      m_current += toCopy;
+      buffer += toCopy;
+      size -= toCopy;
+    }
+  if (m_current < m_zeroEnd)
+    {
+      uint32_t toCopy = std::min (size, m_zeroEnd - m_current);
+      memset (buffer, 0, toCopy);
+      m_current += toCopy;
+      buffer += toCopy;
+      size -= toCopy;
+    }
+  if (size > 0)
+    {
+      memcpy (buffer, &m_data[m_current - (m_zeroEnd - m_zeroStart)], size);
+      m_current += size;
     }
 }
 
@@ -1140,18 +1462,43 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
-
-  while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
-  return ~sum;
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  /* see RFC 1071 to understand this code. The data before and after 
+   * the zero area are summed as two contiguous spans. The zero area
+   * adds nothing, but it may shift the data after it by one byte, 
+   * in which case the sum of that span is byte-swapped (RFC 1071, 
+   * section 2.B). */
+  uint64_t sum = initialChecksum;
+  uint32_t left = size;
+  uint32_t offset = 0;
+  if (m_current < m_zeroStart)
+    {
+      uint32_t toSum = std::min (left, m_zeroStart - m_current);
+      sum += ChecksumSum (&m_data[m_current], toSum);
+      m_current += toSum;
+      offset += toSum;
+      left -= toSum;
+    }
+  if (m_current < m_zeroEnd)
+    {
+      uint32_t toSkip = std::min (left, m_zeroEnd - m_current);
+      m_current += toSkip;
+      offset += toSkip;
+      left -= toSkip;
+    }
+  if (left > 0)
+    {
+      uint16_t tail = ChecksumFold (ChecksumSum (&m_data[m_current - (m_zeroEnd - m_zeroStart)], left));
+      if (offset & 1)
+        {
+          tail = (tail << 8) | (tail >> 8);
+        }
+      sum += tail;
+      m_current += left;
+    }
+  return ~ChecksumFold (sum);
 }
 
 uint32_t 
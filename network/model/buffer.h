@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "thread-local.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -640,7 +641,75 @@ private:
    * \param initialize initialize the buffer with zeroes.
    */
   Buffer (uint32_t dataSize, bool initialize);
+  /**
+   * \brief Constructor
+   *
+   * The buffer will be initialized with zeroes up to its size, and
+   * up to headroom bytes can later be added at its start without
+   * reallocating its data.
+   *
+   * \param dataSize the buffer size.
+   * \param initialize must be true.
+   * \param headroom the number of bytes to reserve before the data.
+   */
+  Buffer (uint32_t dataSize, bool initialize, uint32_t headroom);
   ~Buffer ();
+
+  /**
+   * \brief Make sure that headroom bytes can be added at the start
+   * of the buffer without reallocating its data.
+   *
+   * The data is reallocated now if there is not enough room before it,
+   * or if that room is shared with another buffer which already uses it.
+   *
+   * \param headroom the number of bytes to reserve before the data
+   */
+  void ReserveHeadroom (uint32_t headroom);
+  /**
+   * \returns the number of times AddAtStart had to reallocate the
+   * data of a buffer because there was not enough room before it
+   */
+  static uint64_t GetHeadroomMisses (void);
+  /**
+   * \brief Reset the headroom miss counter
+   */
+  static void ResetHeadroomMisses (void);
+
+  /**
+   * \brief Set the maximum number of free data blocks kept for reuse in
+   * the size class which holds blocks of the given size.
+   *
+   * The data blocks of destroyed buffers are recycled through a free list
+   * per size class. Size classes are powers of two, from 64 bytes to
+   * 64 KiB; larger blocks are never kept. By default, each size class
+   * keeps up to 1000 blocks.
+   *
+   * \param size a block size in the size class to configure
+   * \param cap the maximum number of free blocks of the size class
+   */
+  static void SetFreeListCap (uint32_t size, uint32_t cap);
+  /**
+   * \param size a block size in the size class
+   * \returns the maximum number of free blocks of the size class
+   */
+  static uint32_t GetFreeListCap (uint32_t size);
+  /**
+   * \returns the number of data block requests served by the free list
+   */
+  static uint64_t GetFreeListHits (void);
+  /**
+   * \returns the number of data block requests which had to allocate memory
+   */
+  static uint64_t GetFreeListMisses (void);
+  /**
+   * \returns the number of bytes currently retained by the free list
+   */
+  static uint64_t GetFreeListBytes (void);
+  /**
+   * \brief Reset the free list hit and miss counters
+   */
+  static void ResetFreeListStatistics (void);
+
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -711,6 +780,21 @@ private:
    * \param zeroSize the zeroes size
    */
   void Initialize (uint32_t zeroSize);
+  /**
+   * \brief Initializes the buffer with a number of zeroes and
+   * some room before them.
+   *
+   * \param zeroSize the zeroes size
+   * \param headroom the room before the zeroes
+   */
+  void Initialize (uint32_t zeroSize, uint32_t headroom);
+  /**
+   * \brief Move the data to a new, unshared, data block with
+   * room for headroom bytes before it.
+   *
+   * \param headroom the room before the data
+   */
+  void Reallocate (uint32_t headroom);
 
   /**
    * \brief Get the buffer real size.
@@ -764,9 +848,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value. Each thread has its own, see Buffer::Create.
    */
-  static uint32_t g_recommendedStart;
+  static NS_THREAD_LOCAL uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -789,17 +873,35 @@ private:
    */
   uint32_t m_end;
 
+  /// Number of size classes of the free list
+  static const uint32_t FREE_LIST_CLASSES = 11;
+  /// Size of the data blocks of the smallest size class
+  static const uint32_t FREE_LIST_MIN_SIZE = 64;
+
+  /**
+   * \brief Get the size class of a data block
+   * \param size the data block size
+   * \returns the index of the smallest size class holding size bytes,
+   * or FREE_LIST_CLASSES if size is larger than all of them
+   */
+  static uint32_t GetSizeClass (uint32_t size);
+
+  static uint32_t g_freeListCap[FREE_LIST_CLASSES]; //!< Max free blocks per size class
+  static NS_THREAD_LOCAL uint64_t g_freeListHits;   //!< Data block requests served by the free list
+  static NS_THREAD_LOCAL uint64_t g_freeListMisses; //!< Data block requests which allocated memory
+  static NS_THREAD_LOCAL uint64_t g_freeListBytes;  //!< Bytes retained by the free list
+  static NS_THREAD_LOCAL uint64_t g_headroomMisses; //!< Reallocations for lack of headroom
+
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
+  /// Container for buffer data of one size class
   typedef std::vector<struct Buffer::Data*> FreeList;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static NS_THREAD_LOCAL FreeList *g_freeList; //!< Buffer data containers, one per size class
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "thread-local.h"
 #include <vector>
 #include <cstring>
 
@@ -52,12 +53,14 @@ struct ByteTagListData {
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+static thread_local class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+} g_freeListStorage; //!< Container for struct ByteTagListData, per thread
+static NS_THREAD_LOCAL ByteTagListDataFreeList *g_freeList = 0; //!< g_freeListStorage, 0 until first used
+static NS_THREAD_LOCAL bool g_freeListDestroyed = false; //!< true once g_freeListStorage has been destroyed
+static NS_THREAD_LOCAL uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -68,6 +71,8 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       uint8_t *buffer = (uint8_t *)(*i);
       delete [] buffer;
     }
+  g_freeList = 0;
+  g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -106,9 +111,19 @@ ByteTagList::Iterator::PrepareForNext (void)
       TagBuffer buf = TagBuffer (m_current, m_end);
       m_nextTid = buf.ReadU32 ();
       m_nextSize = buf.ReadU32 ();
-      m_nextStart = buf.ReadU32 () + m_adjustment;
-      m_nextEnd = buf.ReadU32 () + m_adjustment;
-      if (m_nextStart >= m_offsetEnd || m_nextEnd <= m_offsetStart)
+      m_nextStart = buf.ReadU32 ();
+      m_nextEnd = buf.ReadU32 ();
+      bool cut = false;
+      if (m_current < m_clipLimit)
+        {
+          // apply the pending cuts of AddAtStart and AddAtEnd
+          cut = m_nextEnd <= m_clipStart || m_nextStart >= m_clipEnd;
+          m_nextStart = std::max (m_nextStart, m_clipStart);
+          m_nextEnd = std::min (m_nextEnd, m_clipEnd);
+        }
+      m_nextStart += m_adjustment;
+      m_nextEnd += m_adjustment;
+      if (cut || m_nextStart >= m_offsetEnd || m_nextEnd <= m_offsetStart)
         {
           m_current += 4 + 4 + 4 + 4 + m_nextSize;
         }
@@ -118,14 +133,18 @@ ByteTagList::Iterator::PrepareForNext (void)
         }
     }
 }
-ByteTagList::Iterator::Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment)
+ByteTagList::Iterator::Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment,
+                                 uint8_t *clipLimit, int32_t clipStart, int32_t clipEnd)
   : m_current (start),
     m_end (end),
     m_offsetStart (offsetStart),
     m_offsetEnd (offsetEnd),
-    m_adjustment (adjustment)
+    m_adjustment (adjustment),
+    m_clipLimit (clipLimit),
+    m_clipStart (clipStart),
+    m_clipEnd (clipEnd)
 {
-  NS_LOG_FUNCTION (this << &start << &end << offsetStart << offsetEnd << adjustment);
+  NS_LOG_FUNCTION (this << &start << &end << offsetStart << offsetEnd << adjustment << clipStart << clipEnd);
   PrepareForNext ();
 }
 
@@ -141,6 +160,9 @@ ByteTagList::ByteTagList ()
   : m_minStart (INT32_MAX),
     m_maxEnd (INT32_MIN),
     m_adjustment (0),
+    m_clipStart (INT32_MIN),
+    m_clipEnd (INT32_MAX),
+    m_clipUsed (0),
     m_used (0),
     m_data (0)
 {
@@ -150,6 +172,9 @@ ByteTagList::ByteTagList (const ByteTagList &o)
   : m_minStart (o.m_minStart),
     m_maxEnd (o.m_maxEnd),
     m_adjustment (o.m_adjustment),
+    m_clipStart (o.m_clipStart),
+    m_clipEnd (o.m_clipEnd),
+    m_clipUsed (o.m_clipUsed),
     m_used (o.m_used),
     m_data (o.m_data)
 {
@@ -171,6 +196,9 @@ ByteTagList::operator = (const ByteTagList &o)
   m_minStart = o.m_minStart;
   m_maxEnd = o.m_maxEnd;
   m_adjustment = o.m_adjustment;
+  m_clipStart = o.m_clipStart;
+  m_clipEnd = o.m_clipEnd;
+  m_clipUsed = o.m_clipUsed;
   m_data = o.m_data;
   m_used = o.m_used;
   if (m_data != 0)
@@ -246,6 +274,9 @@ ByteTagList::RemoveAll (void)
   m_minStart = INT32_MAX;
   m_maxEnd = INT32_MIN;
   m_adjustment = 0;
+  m_clipStart = INT32_MIN;
+  m_clipEnd = INT32_MAX;
+  m_clipUsed = 0;
   m_data = 0;
   m_used = 0;
 }
@@ -265,44 +296,51 @@ ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
   if (m_data == 0)
     {
-      return Iterator (0, 0, offsetStart, offsetEnd, 0);
+      return Iterator (0, 0, offsetStart, offsetEnd, 0, 0, offsetStart, offsetEnd);
     }
   else
     {
-      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
+      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment,
+                       &m_data->data[m_clipUsed], m_clipStart, m_clipEnd);
     }
 }
 
-void 
-ByteTagList::AddAtEnd (int32_t appendOffset)
+void
+ByteTagList::PrepareClip (void)
 {
-  NS_LOG_FUNCTION (this << appendOffset);
-  if (m_maxEnd <= appendOffset - m_adjustment)
+  NS_LOG_FUNCTION (this);
+  if (m_clipUsed == 0 || m_clipUsed == m_used)
     {
+      // the clip window covers all the tags already
+      m_clipUsed = m_used;
       return;
     }
+  NS_LOG_LOGIC ("tags were added since the last cut, rebuilding the list");
   ByteTagList list;
-  ByteTagList::Iterator i = BeginAll ();
+  // m_minStart and m_maxEnd bound all the stored tags, so only the clip
+  // window cuts them
+  ByteTagList::Iterator i = Begin (m_minStart + m_adjustment, m_maxEnd + m_adjustment);
   while (i.HasNext ())
     {
       ByteTagList::Iterator::Item item = i.Next ();
-
-      if (item.start >= appendOffset)
-        {
-          continue;
-        }
-      if (item.end > appendOffset)
-        {
-          item.end = appendOffset;
-        }
       TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
       buf.CopyFrom (item.buf);
-      if (item.end > m_maxEnd)
-        {
-          m_maxEnd = item.end;
-        }
     }
   *this = list;
+  m_clipUsed = m_used;
+}
+
+void 
+ByteTagList::AddAtEnd (int32_t appendOffset)
+{
+  NS_LOG_FUNCTION (this << appendOffset);
+  if (m_maxEnd <= appendOffset - m_adjustment)
+    {
+      return;
+    }
+  PrepareClip ();
+  m_clipEnd = std::min (m_clipEnd, appendOffset - m_adjustment);
+  m_maxEnd = m_clipEnd;
 }
 
 void 
@@ -313,29 +351,9 @@ ByteTagList::AddAtStart (int32_t prependOffset)
     {
       return;
     }
-  m_minStart = INT32_MAX;
-  ByteTagList list;
-  ByteTagList::Iterator i = BeginAll ();
-  while (i.HasNext ())
-    {
-      ByteTagList::Iterator::Item item = i.Next ();
-
-      if (item.end <= prependOffset)
-        {
-          continue;
-        }
-      if (item.start < prependOffset)
-        {
-          item.start = prependOffset;
-        }
-      TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
-      buf.CopyFrom (item.buf);
-      if (item.start < m_minStart)
-        {
-          m_minStart = item.start;
-        }
-    }
-  *this = list;
+  PrepareClip ();
+  m_clipStart = std::max (m_clipStart, prependOffset - m_adjustment);
+  m_minStart = m_clipStart;
 }
 
 #ifdef USE_FREE_LIST
@@ -344,10 +362,10 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (g_freeList != 0 && !g_freeList->empty ())
     {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
+      struct ByteTagListData *data = g_freeList->back ();
+      g_freeList->pop_back ();
       NS_ASSERT (data != 0);
       if (data->size >= size)
         {
@@ -378,7 +396,12 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeList == 0 && !g_freeListDestroyed)
+        {
+          g_freeList = &g_freeListStorage;
+        }
+      if (g_freeList == 0 ||
+          g_freeList->size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -386,7 +409,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
         }
       else
         {
-          g_freeList.push_back (data);
+          g_freeList->push_back (data);
         }
     }
 }
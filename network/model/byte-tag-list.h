@@ -59,6 +59,12 @@ struct ByteTagListData;
  *     the boundaries before returning item. However, when packet is extending,
  *     it calls ByteTagList::AddAtStart or ByteTagList::AddAtEnd to cut byte
  *     tags that will otherwise cover new bytes.
+ *
+ *   - Cutting is lazy: AddAtStart and AddAtEnd only narrow a clip window
+ *     which applies to the tags stored so far, and the iterator clips
+ *     these tags against it. The tag byte buffer is only rebuilt when the
+ *     window changes after more tags were added, so prepending headers
+ *     to a tagged packet costs constant time.
  */
 class ByteTagList
 {
@@ -121,8 +127,12 @@ private:
      * \param offsetStart offset to the start of the tag from the virtual byte buffer
      * \param offsetEnd offset to the end of the tag from the virtual byte buffer
      * \param adjustment adjustment to byte tag offsets
+     * \param clipLimit end of the tags subject to the clip window
+     * \param clipStart start of the clip window, before adjustment
+     * \param clipEnd end of the clip window, before adjustment
      */
-    Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment);
+    Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment,
+              uint8_t *clipLimit, int32_t clipStart, int32_t clipEnd);
 
     /**
      * \brief Prepare the iterator for the next tag
@@ -133,6 +143,9 @@ private:
     int32_t m_offsetStart;  //!< Offset to the start of the tag from the virtual byte buffer
     int32_t m_offsetEnd;    //!< Offset to the end of the tag from the virtual byte buffer
     int32_t m_adjustment;   //!< Adjustment to byte tag offsets
+    uint8_t *m_clipLimit;   //!< End of the tags subject to the clip window
+    int32_t m_clipStart;    //!< Start of the clip window, before adjustment
+    int32_t m_clipEnd;      //!< End of the clip window, before adjustment
     uint32_t m_nextTid;     //!< TypeId of the next tag
     uint32_t m_nextSize;    //!< Size of the next tag
     int32_t m_nextStart;    //!< Start of the next tag
@@ -211,6 +224,9 @@ private:
   /**
    * Make sure that all offsets are smaller than appendOffset which represents
    * the location where new bytes have been added to the byte buffer.
+   *
+   * The tags are not rewritten: the cut is recorded in the clip window
+   * and applied by the iterators.
    * 
    * \param appendOffset maximum offset value
    *
@@ -220,6 +236,9 @@ private:
    * Make sure that all offsets are bigger than prependOffset which represents
    * the location where new bytes have been added to the byte buffer.
    *
+   * The tags are not rewritten: the cut is recorded in the clip window
+   * and applied by the iterators.
+   *
    * \param prependOffset minimum offset value
    *
    */
@@ -233,6 +252,15 @@ private:
    */
   ByteTagList::Iterator BeginAll (void) const;
 
+  /**
+   * \brief Prepare the clip window to be narrowed.
+   *
+   * The clip window applies to the tags stored when it was last narrowed.
+   * If tags were added since, the list is rebuilt with the window applied
+   * so that the narrowed window can cover all the tags.
+   */
+  void PrepareClip (void);
+
   /**
    * \brief Allocate the memory for the ByteTagListData
    * \param size the memory to allocate
@@ -249,6 +277,9 @@ private:
   int32_t m_minStart; //!< minimal start offset
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
+  int32_t m_clipStart; //!< start of the clip window, before adjustment
+  int32_t m_clipEnd; //!< end of the clip window, before adjustment
+  uint32_t m_clipUsed; //!< the number of bytes in the buffer subject to the clip window
   uint32_t m_used; //!< the number of used bytes in the buffer
   struct ByteTagListData *m_data; //!< the ByteTagListData structure
 };
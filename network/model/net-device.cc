@@ -30,6 +30,61 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NetDevice");
 
+thread_local QueueItem::ItemFreeList QueueItem::m_freeListStorage;
+NS_THREAD_LOCAL QueueItem::ItemFreeList *QueueItem::m_freeList = 0;
+NS_THREAD_LOCAL bool QueueItem::m_freeListDestroyed = false;
+const uint32_t QueueItem::FREE_LIST_CAP;
+
+QueueItem::ItemFreeList::~ItemFreeList ()
+{
+  NS_LOG_FUNCTION (this);
+  for (iterator i = begin (); i != end (); i++)
+    {
+      ::operator delete (*i);
+    }
+  clear ();
+  QueueItem::m_freeList = 0;
+  QueueItem::m_freeListDestroyed = true;
+}
+
+void *
+QueueItem::operator new (size_t size)
+{
+  if (size != sizeof (QueueItem) || m_freeList == 0 || m_freeList->empty ())
+    {
+      return ::operator new (size);
+    }
+  void *p = m_freeList->back ();
+  m_freeList->pop_back ();
+  return p;
+}
+
+void
+QueueItem::operator delete (void *p, size_t size)
+{
+  if (size != sizeof (QueueItem) || m_freeListDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  if (m_freeList == 0)
+    {
+      m_freeList = &m_freeListStorage;
+    }
+  if (m_freeList->size () >= FREE_LIST_CAP)
+    {
+      ::operator delete (p);
+      return;
+    }
+  m_freeList->push_back (p);
+}
+
+uint32_t
+QueueItem::GetFreeListSize (void)
+{
+  return m_freeList == 0 ? 0 : m_freeList->size ();
+}
+
 QueueItem::QueueItem (Ptr<Packet> p)
 {
   m_packet = p;
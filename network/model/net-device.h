@@ -29,6 +29,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "address.h"
+#include "thread-local.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 
@@ -110,7 +111,46 @@ public:
    */
   typedef void (* TracedCallback) (Ptr<const QueueItem> item);
 
+  /**
+   * \brief Allocate the memory for a queue item
+   *
+   * The memory of QueueItem objects is recycled through a free list, so
+   * that wrapping a packet into a queue item on the transmission path does
+   * not hit the allocator. Subclasses, whose size differs, are allocated
+   * with the global operator new.
+   *
+   * \param size the size of the object to allocate
+   * \return the allocated memory
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Release the memory of a queue item, keeping it for later reuse
+   * \param p the memory to release
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+  /**
+   * \returns the number of queue item memory blocks kept for reuse
+   */
+  static uint32_t GetFreeListSize (void);
+
+  /// The maximum number of queue item memory blocks kept for reuse
+  static const uint32_t FREE_LIST_CAP = 1000;
+
 private:
+  /**
+   * \brief Class to hold the recycled queue item memory blocks
+   */
+  class ItemFreeList : public std::vector<void *>
+  {
+public:
+    ~ItemFreeList ();
+  };
+
+  static thread_local ItemFreeList m_freeListStorage; //!< the recycled queue items
+  static NS_THREAD_LOCAL ItemFreeList *m_freeList; //!< the recycled queue items, 0 until first used
+  static NS_THREAD_LOCAL bool m_freeListDestroyed; //!< true once m_freeListStorage has been destroyed
+
   /**
    * \brief Default constructor
    *
@@ -31,12 +31,16 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
-bool PacketMetadata::m_enable = false;
-bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+NS_THREAD_LOCAL bool PacketMetadata::m_enable = false;
+NS_THREAD_LOCAL bool PacketMetadata::m_enableChecking = false;
+NS_THREAD_LOCAL bool PacketMetadata::m_metadataSkipped = false;
+NS_THREAD_LOCAL uint32_t PacketMetadata::m_samplingPeriod = 1;
+NS_THREAD_LOCAL bool PacketMetadata::m_samplingByPredicate = false;
+thread_local Callback<bool, uint64_t> PacketMetadata::m_samplingPredicate;
+NS_THREAD_LOCAL uint32_t PacketMetadata::m_maxSize = 0;
+NS_THREAD_LOCAL uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeListStorage;
+NS_THREAD_LOCAL PacketMetadata::DataFreeList *PacketMetadata::m_freeList = 0;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,6 +49,7 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
+  PacketMetadata::m_freeList = 0;
   PacketMetadata::m_enable = false;
 }
 
@@ -70,6 +75,38 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableSampling (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  NS_ASSERT (n > 0);
+  Enable ();
+  m_samplingPeriod = n;
+  m_samplingByPredicate = false;
+  m_samplingPredicate = Callback<bool, uint64_t> ();
+}
+
+void
+PacketMetadata::EnableSampling (Callback<bool, uint64_t> predicate)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_samplingPeriod = 1;
+  m_samplingByPredicate = !predicate.IsNull ();
+  m_samplingPredicate = predicate;
+}
+
+bool
+PacketMetadata::IsSampled (uint64_t uid)
+{
+  if (m_samplingByPredicate)
+    {
+      return m_samplingPredicate (uid);
+    }
+  // the lower 32 bits are the global uid, see Packet::Packet
+  return (uid & 0xffffffff) % m_samplingPeriod == 0;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -576,10 +613,10 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (m_freeList != 0 && !m_freeList->empty ()) 
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
+      struct PacketMetadata::Data *data = m_freeList->back ();
+      m_freeList->pop_back ();
       if (data->m_size >= size) 
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
@@ -602,16 +639,20 @@ PacketMetadata::Recycle (struct PacketMetadata::Data *data)
       PacketMetadata::Deallocate (data);
       return;
     } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+  if (m_freeList == 0)
+    {
+      m_freeList = &m_freeListStorage;
+    }
+  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList->size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
+  if (m_freeList->size () > 1000 ||
       data->m_size < m_maxSize) 
     {
       PacketMetadata::Deallocate (data);
     } 
   else 
     {
-      m_freeList.push_back (data);
+      m_freeList->push_back (data);
     }
 }
 
@@ -664,9 +705,8 @@ void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
 
@@ -686,9 +726,8 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -734,9 +773,8 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -756,9 +794,8 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -803,9 +840,17 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
+      return;
+    }
+  if (!o.m_recorded)
+    {
+      // The bytes of the other packet are not described: drop
+      // the metadata of this packet rather than leave it partial.
+      m_head = 0xffff;
+      m_tail = 0xffff;
+      m_recorded = false;
       return;
     }
   if (m_tail == 0xffff)
@@ -880,9 +925,8 @@ void
 PacketMetadata::AddPaddingAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  if (!m_enable)
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
 }
@@ -891,9 +935,8 @@ PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -923,6 +966,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_recorded = true;
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -954,9 +998,8 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -987,6 +1030,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_recorded = true;
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1037,6 +1081,13 @@ PacketMetadata::GetTotalSize (void) const
   return totalSize;
 }
 
+bool
+PacketMetadata::IsRecorded (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_recorded;
+}
+
 uint64_t 
 PacketMetadata::GetUid (void) const
 {
@@ -1139,10 +1190,10 @@ PacketMetadata::GetSerializedSize (void) const
   // add 8 bytes for the packet uid
   totalSize += 8;
 
-  // if packet-metadata not enabled, total size
+  // if packet-metadata not recorded, total size
   // is simply 4-bytes for itself plus 8-bytes 
   // for packet uid
-  if (!m_enable)
+  if (!m_recorded)
     {
       return totalSize;
     }
@@ -1333,6 +1384,9 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
       uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
       UpdateTail (tmp);
     }
+  // the sender may not have recorded the metadata of this packet
+  m_recorded = m_enable &&
+    (m_head != 0xffff || (m_samplingPeriod == 1 && !m_samplingByPredicate));
   NS_ASSERT (desSize == 0);
   return (desSize !=0) ? 0 : 1;
 }
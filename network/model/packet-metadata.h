@@ -27,6 +27,7 @@
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#include "thread-local.h"
 
 namespace ns3 {
 
@@ -159,6 +160,27 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata for one packet in n
+   *
+   * Only the packets whose uid is a multiple of n record their
+   * metadata: the others stay on the same path as when the metadata
+   * is disabled.
+   *
+   * \param n the sampling period, in packets
+   */
+  static void EnableSampling (uint32_t n);
+  /**
+   * \brief Enable the packet metadata for the packets selected by
+   * a predicate
+   *
+   * The predicate is called once, with the packet uid, when a
+   * packet is created, and the packet records its metadata only
+   * if it returns true.
+   *
+   * \param predicate the sampling predicate
+   */
+  static void EnableSampling (Callback<bool, uint64_t> predicate);
 
   /**
    * \brief Constructor
@@ -238,6 +260,11 @@ private:
    */
   void RemoveAtEnd (uint32_t end);
 
+  /**
+   * \brief Check if the metadata of the packet is recorded
+   * \returns true if the packet records its metadata
+   */
+  bool IsRecorded (void) const;
   /**
    * \brief Get the packet Uid
    * \return the packet Uid
@@ -655,20 +682,37 @@ public:
    * \param data the buffer data storage
    */
   static void Deallocate (struct PacketMetadata::Data *data);
+  /**
+   * \brief Check if a new packet must record its metadata
+   * \param uid the packet uid
+   * \returns true if metadata is enabled and the packet is sampled
+   */
+  static bool IsSampled (uint64_t uid);
+  /**
+   * \brief Check if an operation must skip the metadata
+   *
+   * \returns true if the metadata of this packet is not recorded
+   */
+  inline bool IsSkipped (void) const;
 
-  static DataFreeList m_freeList; //!< the metadata data storage
-  static bool m_enable; //!< Enable the packet metadata
-  static bool m_enableChecking; //!< Enable the packet metadata checking
+  static thread_local DataFreeList m_freeListStorage; //!< the metadata data storage
+  static NS_THREAD_LOCAL DataFreeList *m_freeList; //!< the metadata data storage, 0 until first used
+  static NS_THREAD_LOCAL bool m_enable; //!< Enable the packet metadata
+  static NS_THREAD_LOCAL bool m_enableChecking; //!< Enable the packet metadata checking
 
   /**
    * Set to true when adding metadata to a packet is skipped because
    * m_enable is false; used to detect enabling of metadata in the
    * middle of a simulation, which isn't allowed.
    */
-  static bool m_metadataSkipped;
+  static NS_THREAD_LOCAL bool m_metadataSkipped;
+
+  static NS_THREAD_LOCAL uint32_t m_samplingPeriod; //!< Record one packet in this many
+  static NS_THREAD_LOCAL bool m_samplingByPredicate; //!< True to select the packets with m_samplingPredicate
+  static thread_local Callback<bool, uint64_t> m_samplingPredicate; //!< Select the recorded packets
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static NS_THREAD_LOCAL uint32_t m_maxSize; //!< maximum metadata size
+  static NS_THREAD_LOCAL uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -679,6 +723,7 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  bool m_recorded; //!< true if the metadata of this packet is recorded
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -691,6 +736,7 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_recorded (m_enable && IsSampled (uid)),
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
@@ -704,6 +750,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_recorded (o.m_recorded),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
@@ -729,9 +776,23 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_recorded = o.m_recorded;
   m_packetUid = o.m_packetUid;
   return *this;
 }
+bool
+PacketMetadata::IsSkipped (void) const
+{
+  if (m_recorded)
+    {
+      return false;
+    }
+  if (!m_enable)
+    {
+      m_metadataSkipped = true;
+    }
+  return true;
+}
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
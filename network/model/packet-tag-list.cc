@@ -154,9 +154,33 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 
 }
 
+uint32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  uint32_t i = 0;
+  while (i < m_nInline && m_inline[i].tid != tid)
+    {
+      i++;
+    }
+  return i;
+}
+
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_nInline)
+    {
+      NS_LOG_INFO ("found tid in inline slot " << i);
+      tag.Deserialize (TagBuffer (m_inline[i].data,
+                                  m_inline[i].data + TagData::MAX_SIZE));
+      // keep the remaining inline tags in order
+      for (m_nInline--; i < m_nInline; i++)
+        {
+          m_inline[i] = m_inline[i + 1];
+        }
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
@@ -196,6 +220,14 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_nInline)
+    {
+      NS_LOG_INFO ("found tid in inline slot " << i);
+      tag.Serialize (TagBuffer (m_inline[i].data,
+                                m_inline[i].data + tag.GetSerializedSize ()));
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -245,19 +277,29 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT_MSG (FindInline (tag.GetInstanceTypeId ()) == m_nInline, "Error: cannot add the same kind of tag twice.");
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (), "Error: cannot add the same kind of tag twice.");
     }
+  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  if (m_nInline < INLINE_TAGS)
+    {
+      struct TagSlot *slot = &self->m_inline[m_nInline];
+      slot->tid = tag.GetInstanceTypeId ();
+      tag.Serialize (TagBuffer (slot->data, slot->data + tag.GetSerializedSize ()));
+      self->m_nInline++;
+      return;
+    }
   struct TagData * head = new struct TagData ();
   head->count = 1;
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
   tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
 
-  const_cast<PacketTagList *> (this)->m_next = head;
+  self->m_next = head;
 }
 
 bool
@@ -265,6 +307,14 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  uint32_t i = FindInline (tid);
+  if (i < m_nInline)
+    {
+      /* found inline tag */
+      tag.Deserialize (TagBuffer (const_cast<uint8_t *> (m_inline[i].data),
+                                  const_cast<uint8_t *> (m_inline[i].data) + TagData::MAX_SIZE));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -284,5 +334,18 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+uint32_t
+PacketTagList::GetNInlineTags (void) const
+{
+  return m_nInline;
+}
+
+const struct PacketTagList::TagSlot *
+PacketTagList::GetInlineTag (uint32_t i) const
+{
+  NS_ASSERT (i < m_nInline);
+  return &m_inline[i];
+}
+
 } /* namespace ns3 */
 
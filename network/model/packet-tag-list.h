@@ -120,6 +120,15 @@ class Tag;
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
  *
+ * \par <b> Inline slots: </b>
+ * \n
+ * Most packets carry very few tags, so the first #INLINE_TAGS tags are
+ * stored by value in slots embedded in the PacketTagList itself, and only
+ * the tags added past that spill into the tree of TagData described above.
+ * Copying a PacketTagList copies the occupied slots and shares the spilled
+ * tags as described above; adding, finding, replacing and removing an
+ * inline tag never allocates memory.
+ *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
@@ -167,6 +176,23 @@ public:
     uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
+  /**
+   * Inline storage for a serialized tag.
+   */
+  struct TagSlot
+  {
+    TypeId tid;                               /**< Type of the tag serialized into #data */
+    uint8_t data[TagData::MAX_SIZE];          /**< Serialization buffer */
+  };  /* struct TagSlot */
+
+  /**
+   * \brief Number of tags stored inline, before spilling into TagData
+   */
+  enum InlineTags_e
+  {
+    INLINE_TAGS = 3           /**< Number of inline TagSlot */
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -176,8 +202,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the inline tags of \pname{o}, then
+   * points to the same \ref TagData as \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -186,8 +212,9 @@ public:
    * \param [in] o The PacketTagList to copy.
    * \returns the copied object
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy by #RemoveAll, then copying
+   * the inline tags of \pname{o} and pointing to the same
+   * \ref TagData as \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
@@ -234,9 +261,18 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of the list of spilled tags
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns the number of tags stored inline
+   */
+  uint32_t GetNInlineTags (void) const;
+  /**
+   * \param [in] i The index of the inline tag, less than GetNInlineTags ()
+   * \returns pointer to the i-th inline tag
+   */
+  const struct PacketTagList::TagSlot *GetInlineTag (uint32_t i) const;
 
 private:
   /**
@@ -287,10 +323,26 @@ private:
    */
   bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
 
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The type of the tag to find.
+   * \returns the index of the inline tag, or #m_nInline if not found.
+   */
+  uint32_t FindInline (TypeId tid) const;
+
   /**
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /**
+   * Number of occupied inline slots
+   */
+  uint32_t m_nInline;
+  /**
+   * Inline tags, in the order they were added
+   */
+  struct TagSlot m_inline[INLINE_TAGS];
 };
 
 } // namespace ns3
@@ -302,13 +354,19 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_nInline (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_nInline (o.m_nInline)
 {
+  for (uint32_t i = 0; i < m_nInline; i++)
+    {
+      m_inline[i] = o.m_inline[i];
+    }
   if (m_next != 0)
     {
       m_next->count++;
@@ -319,15 +377,23 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (m_next != o.m_next) 
     {
-      m_next->count++;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          m_next->count++;
+        }
+    }
+  m_nInline = o.m_nInline;
+  for (uint32_t i = 0; i < m_nInline; i++)
+    {
+      m_inline[i] = o.m_inline[i];
     }
   return *this;
 }
@@ -359,6 +425,7 @@ PacketTagList::RemoveAll (void)
       delete prev;
     }
   m_next = 0;
+  m_nInline = 0;
 }
 
 } // namespace ns3
@@ -28,7 +28,24 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+NS_THREAD_LOCAL uint32_t Packet::m_globalUid = 0;
+thread_local Packet::PacketFreeList Packet::m_freeListStorage;
+NS_THREAD_LOCAL Packet::PacketFreeList *Packet::m_freeList = 0;
+NS_THREAD_LOCAL bool Packet::m_freeListDestroyed = false;
+NS_THREAD_LOCAL uint64_t Packet::m_poolHits = 0;
+NS_THREAD_LOCAL uint64_t Packet::m_poolMisses = 0;
+
+Packet::PacketFreeList::~PacketFreeList ()
+{
+  NS_LOG_FUNCTION (this);
+  for (iterator i = begin (); i != end (); i++)
+    {
+      ::operator delete (*i);
+    }
+  clear ();
+  Packet::m_freeList = 0;
+  Packet::m_freeListDestroyed = true;
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,39 +98,48 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const PacketTagList &list)
+  : m_list (&list),
+    m_inline (0),
+    m_current (list.Head ())
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_inline < m_list->GetNInlineTags () || m_current != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
+  if (m_inline < m_list->GetNInlineTags ())
+    {
+      const struct PacketTagList::TagSlot *slot = m_list->GetInlineTag (m_inline);
+      m_inline++;
+      return PacketTagIterator::Item (slot->tid, slot->data);
+    }
   const struct PacketTagList::TagData *prev = m_current;
   m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  return PacketTagIterator::Item (prev->tid, prev->data);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, const uint8_t *data)
+  : m_tid (tid),
+    m_data (data)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data,
+                              (uint8_t*)m_data
                               + PacketTagList::TagData::MAX_SIZE));
 }
 
@@ -224,6 +250,16 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
 {
 }
 
+Ptr<Packet>
+Packet::CreateWithHeadroom (uint32_t size, uint32_t headroom)
+{
+  NS_LOG_FUNCTION (size << headroom);
+  PacketMetadata metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size);
+  m_globalUid++;
+  return Ptr<Packet> (new Packet (Buffer (size, true, headroom), ByteTagList (),
+                                  PacketTagList (), metadata), false);
+}
+
 Ptr<Packet>
 Packet::CreateFragment (uint32_t start, uint32_t length) const
 {
@@ -253,6 +289,13 @@ Packet::GetNixVector (void) const
   return m_nixVector;
 } 
 
+void
+Packet::ReserveHeadroom (uint32_t headroom)
+{
+  NS_LOG_FUNCTION (this << headroom);
+  m_buffer.ReserveHeadroom (headroom);
+}
+
 void
 Packet::AddHeader (const Header &header)
 {
@@ -538,6 +581,26 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnablePrinting (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  PacketMetadata::EnableSampling (n);
+}
+
+void
+Packet::EnablePrinting (Callback<bool, uint64_t> predicate)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableSampling (predicate);
+}
+
+bool
+Packet::IsPrintable (void) const
+{
+  return m_metadata.IsRecorded ();
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -545,6 +608,62 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void *
+Packet::operator new (size_t size)
+{
+  if (size == sizeof (Packet) && m_freeList != 0 && !m_freeList->empty ())
+    {
+      m_poolHits++;
+      void *p = m_freeList->back ();
+      m_freeList->pop_back ();
+      return p;
+    }
+  m_poolMisses++;
+  return ::operator new (size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  if (size != sizeof (Packet) || m_freeListDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  if (m_freeList == 0)
+    {
+      // only reach the pool of this thread through its initialization
+      // wrapper once, the pointer is read at a fixed offset afterwards
+      m_freeList = &m_freeListStorage;
+    }
+  if (m_freeList->size () > 1000)
+    {
+      ::operator delete (p);
+      return;
+    }
+  m_freeList->push_back (p);
+}
+
+uint64_t
+Packet::GetPoolHits (void)
+{
+  return m_poolHits;
+}
+
+uint64_t
+Packet::GetPoolMisses (void)
+{
+  return m_poolMisses;
+}
+
+void
+Packet::ResetPoolStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_poolHits = 0;
+  m_poolMisses = 0;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -881,7 +1000,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList);
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -34,6 +34,7 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include "thread-local.h"
 
 namespace ns3 {
 
@@ -152,10 +153,12 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the ns3::TypeId associated to this tag.
+     * \param data the serialized tag.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data);
+    TypeId m_tid;          //!< the ns3::TypeId associated to this tag
+    const uint8_t *m_data; //!< the serialized tag
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -169,10 +172,12 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the list of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (const PacketTagList &list);
+  const PacketTagList *m_list;                     //!< the list of the items
+  uint32_t m_inline;                               //!< actual position over the inline tags of the list
+  const struct PacketTagList::TagData *m_current;  //!< actual position over the spilled tags of the list
 };
 
 /**
@@ -280,6 +285,20 @@ public:
    * \param size the size of the input buffer.
    */
   Packet (uint8_t const*buffer, uint32_t size);
+  /**
+   * \brief Create a packet with a zero-filled payload and room
+   * for headers.
+   *
+   * Up to headroom bytes of headers can be added to this packet
+   * without reallocating its buffer. This is a named factory rather
+   * than a constructor so that it cannot be confused with
+   * Packet (uint8_t const*buffer, uint32_t size).
+   *
+   * \param size the size of the zero-filled payload
+   * \param headroom the number of header bytes to reserve
+   * \returns the new packet
+   */
+  static Ptr<Packet> CreateWithHeadroom (uint32_t size, uint32_t headroom);
   /**
    * \brief Create a new packet which contains a fragment of the original
    * packet.
@@ -298,6 +317,16 @@ public:
    * \returns the size in bytes of the packet
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \brief Make sure that headroom bytes of headers can be added
+   * to this packet without reallocating its buffer.
+   *
+   * The buffer is reallocated now if it lacks the room: call this
+   * once, before adding a set of headers of known total size.
+   *
+   * \param headroom the number of header bytes to reserve
+   */
+  void ReserveHeadroom (uint32_t headroom);
   /**
    * \brief Add header to this packet.
    *
@@ -490,6 +519,33 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing the metadata of one packet in n.
+   *
+   * Only the packets whose uid is a multiple of n keep their metadata:
+   * Print and ToString produce an empty output for the other ones,
+   * which cost as little as when printing is disabled. Like
+   * EnablePrinting, this must be called before any packet is created.
+   *
+   * \param n the sampling period, in packets
+   */
+  static void EnablePrinting (uint32_t n);
+  /**
+   * \brief Enable printing the metadata of the packets selected by
+   * a predicate.
+   *
+   * The predicate is called with the uid of every new packet and
+   * the packet keeps its metadata only if it returns true.
+   *
+   * \param predicate the sampling predicate
+   */
+  static void EnablePrinting (Callback<bool, uint64_t> predicate);
+  /**
+   * \brief Check if the metadata of this packet is recorded.
+   *
+   * \returns true if Print can describe the content of this packet
+   */
+  bool IsPrintable (void) const;
   /**
    * \brief Enable packets metadata checking.
    *
@@ -502,6 +558,37 @@ public:
    */
   static void EnableChecking (void);
 
+  /**
+   * \brief Allocate the memory for a packet
+   *
+   * The memory of destroyed packets is kept in a pool and reused for the
+   * packets created later on, including the ones created by Copy. The
+   * buffer, metadata and tag storage of a packet are recycled by their
+   * own free lists.
+   *
+   * \param size the size of the object to allocate
+   * \return the allocated memory
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Release the memory of a packet, keeping it in the pool
+   * \param p the memory to release
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+  /**
+   * \returns the number of packet allocations served by the pool
+   */
+  static uint64_t GetPoolHits (void);
+  /**
+   * \returns the number of packet allocations that missed the pool
+   */
+  static uint64_t GetPoolMisses (void);
+  /**
+   * \brief Reset the pool hit and miss counters
+   */
+  static void ResetPoolStatistics (void);
+
   /**
    * \brief Returns number of bytes required for packet
    * serialization.
@@ -727,7 +814,22 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static NS_THREAD_LOCAL uint32_t m_globalUid; //!< Global counter of packets Uid
+
+  /**
+   * \brief Class to hold the memory of destroyed packets
+   */
+  class PacketFreeList : public std::vector<void *>
+  {
+public:
+    ~PacketFreeList ();
+  };
+
+  static thread_local PacketFreeList m_freeListStorage; //!< the pool of packet memory blocks
+  static NS_THREAD_LOCAL PacketFreeList *m_freeList; //!< the pool, 0 until first used
+  static NS_THREAD_LOCAL bool m_freeListDestroyed; //!< true once m_freeListStorage has been destroyed
+  static NS_THREAD_LOCAL uint64_t m_poolHits;      //!< allocations served by the pool
+  static NS_THREAD_LOCAL uint64_t m_poolMisses;    //!< allocations that missed the pool
 };
 
 /**
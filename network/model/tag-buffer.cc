@@ -125,10 +125,9 @@ void
 TagBuffer::Write (const uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  for (uint32_t i = 0; i < size; ++i, ++buffer)
-    {
-      WriteU8 (*buffer);
-    }
+  NS_ASSERT (size <= (uintptr_t)(m_end - m_current));
+  std::memcpy (m_current, buffer, size);
+  m_current += size;
 }
 uint64_t 
 TagBuffer::ReadU64 (void)
@@ -176,10 +175,9 @@ void
 TagBuffer::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  for (uint32_t i = 0; i < size; ++i, ++buffer)
-    {
-      *buffer = ReadU8 ();
-    }
+  NS_ASSERT (size <= (uintptr_t)(m_end - m_current));
+  std::memcpy (buffer, m_current, size);
+  m_current += size;
 }
 TagBuffer::TagBuffer (uint8_t *start, uint8_t *end)
   : m_current (start),
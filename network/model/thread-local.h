@@ -0,0 +1,41 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_THREAD_LOCAL_H
+#define NS3_THREAD_LOCAL_H
+
+/**
+ * \ingroup packet
+ * \def NS_THREAD_LOCAL
+ * \brief Declare a per-thread variable of the packet core.
+ *
+ * The network module is a shared library, where a plain thread_local
+ * variable is reached through a call to __tls_get_addr on every access.
+ * The initial-exec model reads it at a fixed offset from the thread
+ * pointer instead, as cheaply as a global variable.  It takes its space
+ * from the static TLS block, which is only a few dozen bytes here.
+ *
+ * Only use it for variables which need no dynamic initialization nor
+ * destruction: the others are still reached through a call to their
+ * initialization wrapper.
+ */
+#if defined (__GNUC__)
+#define NS_THREAD_LOCAL thread_local __attribute__ ((tls_model ("initial-exec")))
+#else
+#define NS_THREAD_LOCAL thread_local
+#endif
+
+#endif /* NS3_THREAD_LOCAL_H */
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/lwsn-header.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+class BinaryTraceFileTestCase : public TestCase
+{
+public:
+  BinaryTraceFileTestCase ();
+  virtual void DoRun (void);
+};
+
+BinaryTraceFileTestCase::BinaryTraceFileTestCase ()
+  : TestCase ("Check the formatting of binary trace records")
+{
+}
+
+void
+BinaryTraceFileTestCase::DoRun (void)
+{
+  const uint8_t bytes[] = { 0x00, 0x01, 0xab, 0xff, 0x10, 0x20 };
+  Ptr<Packet> p = Create<Packet> (bytes, sizeof (bytes));
+  Ptr<Packet> q = Create<Packet> (100);
+
+  std::stringstream binary;
+  BinaryTraceFile::WriteHeader (binary);
+
+  BinaryTraceFile::Source source;
+  source.m_event = BinaryTraceFile::ENQUEUE;
+  source.m_node = 3;
+  source.m_device = 1;
+  BinaryTraceFile::Write (binary, Seconds (1.5), source, p, 4);
+
+  source.m_event = BinaryTraceFile::DROP;
+  source.m_device = BinaryTraceFile::NO_ID;
+  BinaryTraceFile::Write (binary, MilliSeconds (2250), source, p, 32);
+
+  source.m_event = BinaryTraceFile::RECEIVE;
+  source.m_node = BinaryTraceFile::NO_ID;
+  BinaryTraceFile::Write (binary, Seconds (3), source, q, 0);
+
+  // the header of a reading is decoded as in the ascii traces
+  LwsnHeader header;
+  header.SetType (LwsnHeader::ORIGINAL_TRANSMISSION);
+  header.SetOsid (7);
+  header.SetDid (2);
+  Ptr<Packet> reading = Create<Packet> (30);
+  reading->AddHeader (header);
+  source.m_event = BinaryTraceFile::DEQUEUE;
+  BinaryTraceFile::Write (binary, Seconds (4), source, reading, 32);
+
+  std::ostringstream expected;
+  expected << "+ 1.5 /NodeList/3/DeviceList/1 ns3::Packet uid=" << p->GetUid () << " size=6 [00 01 ab ff]\n"
+           << "d 2.25 /NodeList/3 ns3::Packet uid=" << p->GetUid () << " size=6 [00 01 ab ff 10 20]\n"
+           << "r 3 ns3::Packet uid=" << q->GetUid () << " size=100\n"
+           << "- 4 ns3::LwsnHeader (";
+  header.Print (expected);
+  expected << ") Payload (size=30)\n";
+
+  std::stringstream text;
+  NS_TEST_ASSERT_MSG_EQ (BinaryTraceFile::Format (binary, text), true, "The binary trace should be formatted");
+  NS_TEST_EXPECT_MSG_EQ (text.str (), expected.str (), "Unexpected ascii trace");
+
+  // a record cut short
+  std::string truncated = binary.str ();
+  std::stringstream cut (truncated.substr (0, truncated.size () - 3));
+  std::stringstream ignored;
+  NS_TEST_EXPECT_MSG_EQ (BinaryTraceFile::Format (cut, ignored), false, "A truncated trace should be detected");
+
+  // not a binary trace
+  std::stringstream ascii ("+ 1.5 /NodeList/3/DeviceList/1");
+  NS_TEST_EXPECT_MSG_EQ (BinaryTraceFile::Format (ascii, ignored), false, "An ascii trace should be rejected");
+}
+
+class BinaryTraceFileTestSuite : public TestSuite
+{
+public:
+  BinaryTraceFileTestSuite ()
+    : TestSuite ("binary-trace-file", UNIT)
+  {
+    AddTestCase (new BinaryTraceFileTestCase, TestCase::QUICK);
+  }
+} g_binaryTraceFileTestSuite;
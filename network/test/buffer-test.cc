@@ -359,6 +359,190 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // check bulk reads across the zero area
+  buffer = Buffer (10);
+  buffer.AddAtStart (4);
+  i = buffer.Begin ();
+  i.WriteU8 (1);
+  i.WriteU8 (2);
+  i.WriteU8 (3);
+  i.WriteU8 (4);
+  buffer.AddAtEnd (3);
+  i = buffer.End ();
+  i.Prev (3);
+  i.WriteU8 (5);
+  i.WriteU8 (6);
+  i.WriteU8 (7);
+  uint8_t expected[17] = { 1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 6, 7 };
+  uint8_t bytes[17];
+  for (uint32_t start = 0; start < 17; start++)
+    {
+      for (uint32_t size = 0; start + size <= 17; size++)
+        {
+          memset (bytes, 0xff, sizeof (bytes));
+          i = buffer.Begin ();
+          i.Next (start);
+          i.Read (bytes, size);
+          NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), start + size, "Bad position after Read()");
+          NS_TEST_ASSERT_MSG_EQ (memcmp (bytes, &expected[start], size), 0, "Bad Read() across the zero area");
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+class BufferFreeListTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFreeListTest ();
+};
+
+BufferFreeListTest::BufferFreeListTest ()
+  : TestCase ("Buffer free list size classes") {
+}
+
+void
+BufferFreeListTest::DoRun (void)
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      if (i == 2)
+        {
+          // the previous rounds settled the recommended start and filled
+          // the free list of every size class used
+          Buffer::ResetFreeListStatistics ();
+        }
+      Buffer small;
+      small.AddAtStart (100);
+      Buffer large;
+      large.AddAtStart (3000);
+    }
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetFreeListMisses (), 0, "No buffer should allocate memory");
+  NS_TEST_ASSERT_MSG_GT (Buffer::GetFreeListHits (), 0, "Buffers should reuse free blocks");
+  NS_TEST_ASSERT_MSG_GT (Buffer::GetFreeListBytes (), 3000, "The large block should be kept for reuse");
+
+  uint32_t cap = Buffer::GetFreeListCap (100);
+  NS_TEST_ASSERT_MSG_EQ (cap, 1000, "Unexpected default cap");
+  Buffer::SetFreeListCap (100, 10);
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetFreeListCap (128), 10, "100 and 128 bytes should share a size class");
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetFreeListCap (129), 1000, "129 bytes should be in the next size class");
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetFreeListCap (1 << 20), 0, "Huge blocks should never be kept");
+  Buffer::SetFreeListCap (100, cap);
+}
+//-----------------------------------------------------------------------------
+class BufferHeadroomTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferHeadroomTest ();
+};
+
+BufferHeadroomTest::BufferHeadroomTest ()
+  : TestCase ("Buffer headroom reservation") {
+}
+
+void
+BufferHeadroomTest::DoRun (void)
+{
+  Buffer::ResetHeadroomMisses ();
+  Buffer buffer = Buffer (100, true, 20);
+  buffer.AddAtStart (20);
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetHeadroomMisses (), 0, "The reserved headroom should be used");
+  buffer.AddAtStart (1);
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetHeadroomMisses (), 1, "Adding past the headroom should reallocate");
+
+  Buffer::ResetHeadroomMisses ();
+  buffer = Buffer (100, true, 0);
+  buffer.AddAtStart (4);
+  buffer.Begin ().WriteU32 (0x01020304);
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetHeadroomMisses (), 1, "A buffer without headroom should reallocate");
+  buffer.ReserveHeadroom (20);
+  NS_TEST_ASSERT_MSG_EQ (buffer.Begin ().ReadU32 (), 0x01020304, "ReserveHeadroom should keep the data");
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 104, "ReserveHeadroom should keep the size");
+  buffer.AddAtStart (20);
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetHeadroomMisses (), 1, "ReserveHeadroom should make room");
+  buffer.Begin ().WriteU8 (0, 20);
+
+  // a copy which removed a header and adds another one
+  Buffer copy = buffer;
+  copy.RemoveAtStart (20);
+  copy.ReserveHeadroom (20);
+  copy.AddAtStart (20);
+  copy.Begin ().WriteU8 (0xff, 20);
+  NS_TEST_ASSERT_MSG_EQ (Buffer::GetHeadroomMisses (), 1, "ReserveHeadroom should unshare the room");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Begin ().ReadU8 (), 0, "The original buffer should be untouched");
+}
+//-----------------------------------------------------------------------------
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+private:
+  /**
+   * Checksum computed one word at a time, as a reference
+   * \param i iterator at the start of the data
+   * \param size size of the data
+   * \param initial initial value
+   * \returns the checksum
+   */
+  uint16_t Reference (Buffer::Iterator i, uint16_t size, uint32_t initial);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer IP checksum") {
+}
+
+uint16_t
+BufferChecksumTest::Reference (Buffer::Iterator i, uint16_t size, uint32_t initial)
+{
+  uint32_t sum = initial;
+  for (int j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  for (uint32_t round = 0; round < 200; round++)
+    {
+      // random data around a zero area of random size and position
+      uint32_t zeroSize = rng->GetInteger (0, 100);
+      uint32_t before = rng->GetInteger (0, 1600);
+      uint32_t after = rng->GetInteger (0, 1600);
+      Buffer buffer (zeroSize);
+      buffer.AddAtStart (before);
+      buffer.AddAtEnd (after);
+      Buffer::Iterator i = buffer.Begin ();
+      for (uint32_t j = 0; j < before; j++)
+        {
+          i.WriteU8 (rng->GetInteger (0, 255));
+        }
+      i.Next (zeroSize);
+      for (uint32_t j = 0; j < after; j++)
+        {
+          i.WriteU8 (rng->GetInteger (0, 255));
+        }
+
+      uint32_t start = rng->GetInteger (0, buffer.GetSize ());
+      uint16_t size = rng->GetInteger (0, buffer.GetSize () - start);
+      uint32_t initial = rng->GetInteger (0, 0xffff);
+      i = buffer.Begin ();
+      i.Next (start);
+      Buffer::Iterator j = i;
+      uint16_t checksum = i.CalculateIpChecksum (size, initial);
+      NS_TEST_ASSERT_MSG_EQ (checksum, Reference (j, size, initial), "Bad checksum");
+      NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), start + size, "Bad position after checksum");
+    }
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -371,6 +555,9 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferFreeListTest, TestCase::QUICK);
+  AddTestCase (new BufferHeadroomTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/crc32.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include <ostream>
+#include <vector>
+
+using namespace ns3;
+
+class Crc32TestCase : public TestCase
+{
+public:
+  Crc32TestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Compute the CRC-32 one bit at a time, as a reference
+   * \param data buffer to calculate the checksum for
+   * \param length the length of the buffer (bytes)
+   * \returns the crc-32
+   */
+  uint32_t Reference (const uint8_t *data, uint32_t length);
+};
+
+Crc32TestCase::Crc32TestCase ()
+  : TestCase ("Check the CRC-32 against a bitwise implementation")
+{
+}
+
+uint32_t
+Crc32TestCase::Reference (const uint8_t *data, uint32_t length)
+{
+  uint32_t crc = 0xffffffff;
+  for (uint32_t i = 0; i < length; i++)
+    {
+      crc ^= data[i];
+      for (uint32_t bit = 0; bit < 8; bit++)
+        {
+          crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+        }
+    }
+  return ~crc;
+}
+
+void
+Crc32TestCase::DoRun (void)
+{
+  const uint8_t check[] = "123456789";
+  NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (check, 9), 0xcbf43926, "Bad check value");
+  NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (check, 0), 0, "Bad crc of no data");
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  std::vector<uint8_t> data (4096);
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      data[i] = rng->GetInteger (0, 255);
+    }
+  for (uint32_t round = 0; round < 100; round++)
+    {
+      // random alignment and length, on both sides of the block size
+      uint32_t start = rng->GetInteger (0, 15);
+      uint32_t length = rng->GetInteger (0, round < 50 ? 100 : data.size () - start);
+      uint32_t split = rng->GetInteger (0, length);
+      uint32_t expected = Reference (&data[start], length);
+      NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (&data[start], length), expected, "Bad crc of " << length << " bytes");
+      uint32_t crc = CRC32Update (0, &data[start], split);
+      crc = CRC32Update (crc, &data[start + split], length - split);
+      NS_TEST_EXPECT_MSG_EQ (crc, expected, "Bad crc of " << length << " bytes split at " << split);
+    }
+
+  // a packet made of data around a zero area
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddAtEnd (Create<Packet> (&data[0], 500));
+  Ptr<Packet> q = Create<Packet> (&data[500], 300);
+  q->AddAtEnd (p);
+  std::vector<uint8_t> flat (q->GetSize ());
+  q->CopyData (&flat[0], flat.size ());
+  CRC32StreamBuf crc;
+  std::ostream os (&crc);
+  q->CopyData (&os, q->GetSize ());
+  NS_TEST_EXPECT_MSG_EQ (crc.GetCrc (), Reference (&flat[0], flat.size ()), "Bad crc of a packet");
+}
+
+static class Crc32TestSuite : public TestSuite
+{
+public:
+  Crc32TestSuite ()
+    : TestSuite ("crc32", UNIT)
+  {
+    AddTestCase (new Crc32TestCase (), TestCase::QUICK);
+  }
+} g_crc32TestSuite;
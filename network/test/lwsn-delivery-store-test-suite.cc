@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/lwsn-delivery-store.h"
+
+using namespace ns3;
+
+class LwsnDeliveryStoreTestCase : public TestCase
+{
+public:
+  LwsnDeliveryStoreTestCase ();
+  virtual void DoRun (void);
+};
+
+LwsnDeliveryStoreTestCase::LwsnDeliveryStoreTestCase ()
+  : TestCase ("Check the columns of a delivery file")
+{
+}
+
+void
+LwsnDeliveryStoreTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("deliveries.bin");
+  {
+    Ptr<LwsnDeliveryWriter> writer = Create<LwsnDeliveryWriter> ();
+    NS_TEST_ASSERT_MSG_EQ (writer->Open (filename, 3), true, "Unable to create the delivery file");
+    for (uint16_t i = 0; i < 7; i++)
+      {
+        writer->Write (Seconds (10 + i), i + 1, 100 + i, 1 + i % 2, i % 4 + 1, MilliSeconds (250 * i));
+      }
+    NS_TEST_EXPECT_MSG_EQ (writer->GetNRecords (), 7, "Unexpected number of records written");
+  }
+  // the last chunk is written at Simulator::Destroy
+  Simulator::Destroy ();
+
+  LwsnDeliveryReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Unable to map the delivery file");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNChunks (), 3, "Unexpected number of chunks");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetNRecords (), 7, "Unexpected number of records");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetChunk (2).m_nRecords, 1, "Unexpected number of records in the last chunk");
+
+  uint16_t i = 0;
+  for (uint32_t c = 0; c < reader.GetNChunks (); c++)
+    {
+      LwsnDeliveryReader::Chunk chunk = reader.GetChunk (c);
+      NS_TEST_EXPECT_MSG_EQ (reinterpret_cast<uintptr_t> (chunk.m_time) % 8, 0, "Unaligned time column");
+      NS_TEST_EXPECT_MSG_EQ (reinterpret_cast<uintptr_t> (chunk.m_delay) % 8, 0, "Unaligned delay column");
+      for (uint32_t r = 0; r < chunk.m_nRecords; r++, i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (chunk.m_time[r], Seconds (10 + i).GetNanoSeconds (), "Unexpected time " << i);
+          NS_TEST_EXPECT_MSG_EQ_TOL (chunk.m_delay[r], 0.25 * i, 1e-9, "Unexpected delay " << i);
+          NS_TEST_EXPECT_MSG_EQ (chunk.m_osid[r], i + 1, "Unexpected osid " << i);
+          NS_TEST_EXPECT_MSG_EQ (chunk.m_did[r], 100 + i, "Unexpected did " << i);
+          NS_TEST_EXPECT_MSG_EQ (chunk.m_gateway[r], 1 + i % 2, "Unexpected gateway " << i);
+          NS_TEST_EXPECT_MSG_EQ (chunk.m_hops[r], i % 4 + 1, "Unexpected hops " << i);
+        }
+    }
+  reader.Close ();
+
+  // a chunk cut short is ignored
+  std::ofstream f (filename.c_str (), std::ios::out | std::ios::binary | std::ios::app);
+  uint32_t header[2] = { 5, 0 };
+  f.write (reinterpret_cast<const char *> (header), sizeof (header));
+  f.close ();
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Unable to map the delivery file");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetNChunks (), 3, "A truncated chunk should be ignored");
+}
+
+class LwsnDeliveryStoreTestSuite : public TestSuite
+{
+public:
+  LwsnDeliveryStoreTestSuite ()
+    : TestSuite ("lwsn-delivery-store", UNIT)
+  {
+    AddTestCase (new LwsnDeliveryStoreTestCase, TestCase::QUICK);
+  }
+} g_lwsnDeliveryStoreTestSuite;
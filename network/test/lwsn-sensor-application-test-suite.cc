@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/lwsn-sensor-application.h"
+
+using namespace ns3;
+
+class LwsnSensorApplicationTestCase : public TestCase
+{
+public:
+  LwsnSensorApplicationTestCase (LwsnSensorApplication::TrafficModel model);
+  virtual void DoRun (void);
+private:
+  /**
+   * Record the time and the uid of a reading
+   * \param packet the reading
+   */
+  void Reading (Ptr<const Packet> packet);
+  LwsnSensorApplication::TrafficModel m_model; //!< the traffic model under test
+  std::vector<Time> m_readings; //!< the times of the readings
+  std::set<uint64_t> m_uids; //!< the uids of the readings
+};
+
+LwsnSensorApplicationTestCase::LwsnSensorApplicationTestCase (LwsnSensorApplication::TrafficModel model)
+  : TestCase (model == LwsnSensorApplication::PERIODIC ? "Periodic sensor readings"
+              : model == LwsnSensorApplication::POISSON ? "Poisson sensor readings"
+              : "Bursty sensor readings"),
+    m_model (model)
+{
+}
+
+void
+LwsnSensorApplicationTestCase::Reading (Ptr<const Packet> packet)
+{
+  m_readings.push_back (Simulator::Now ());
+  m_uids.insert (packet->GetUid ());
+}
+
+void
+LwsnSensorApplicationTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  nodes.Get (0)->AddDevice (dev);
+  dev->SetNode (nodes.Get (0));
+  dev->SetChannel (CreateObject<SimpleChannel> ());
+  dev->SetSid (1);
+
+  Ptr<LwsnSensorApplication> app = CreateObject<LwsnSensorApplication> ();
+  app->SetAttribute ("TrafficModel", EnumValue (m_model));
+  app->SetAttribute ("Interval", TimeValue (Seconds (10)));
+  app->SetAttribute ("BurstSize", UintegerValue (3));
+  app->SetAttribute ("BurstSpacing", TimeValue (Seconds (1)));
+  app->SetAttribute ("MaxPackets", UintegerValue (6));
+  app->AssignStreams (1);
+  app->TraceConnectWithoutContext ("Tx", MakeCallback (&LwsnSensorApplicationTestCase::Reading, this));
+  app->TraceConnectWithoutContext ("Drop", MakeCallback (&LwsnSensorApplicationTestCase::Reading, this));
+  nodes.Get (0)->AddApplication (app);
+
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (app->GetSent (), 6, "Unexpected number of readings");
+  NS_TEST_ASSERT_MSG_EQ (m_readings.size (), 6, "Every reading should be traced");
+  NS_TEST_EXPECT_MSG_EQ (m_uids.size (), 6, "Every reading should have a packet uid of its own");
+  for (uint32_t i = 1; i < m_readings.size (); i++)
+    {
+      Time gap = m_readings[i] - m_readings[i - 1];
+      if (m_model == LwsnSensorApplication::PERIODIC)
+        {
+          NS_TEST_EXPECT_MSG_EQ (gap, Seconds (10), "Unexpected periodic interval");
+        }
+      else if (m_model == LwsnSensorApplication::BURSTY && i % 3 != 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (gap, Seconds (1), "Unexpected spacing within a burst");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ ((gap > Seconds (0)), true, "Readings should be drawn in order");
+        }
+    }
+}
+
+class LwsnSensorApplicationTestSuite : public TestSuite
+{
+public:
+  LwsnSensorApplicationTestSuite ()
+    : TestSuite ("lwsn-sensor-application", UNIT)
+  {
+    AddTestCase (new LwsnSensorApplicationTestCase (LwsnSensorApplication::PERIODIC), TestCase::QUICK);
+    AddTestCase (new LwsnSensorApplicationTestCase (LwsnSensorApplication::POISSON), TestCase::QUICK);
+    AddTestCase (new LwsnSensorApplicationTestCase (LwsnSensorApplication::BURSTY), TestCase::QUICK);
+  }
+} g_lwsnSensorApplicationTestSuite;
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/lwsn-header.h"
+#include "ns3/pcap-file.h"
+#include "ns3/lwsn-trace-replay-application.h"
+
+using namespace ns3;
+
+class LwsnTraceReplayTestCase : public TestCase
+{
+public:
+  LwsnTraceReplayTestCase (bool pcap);
+  virtual void DoRun (void);
+private:
+  /**
+   * Record the time and the size of a reading
+   * \param packet the reading
+   */
+  void Reading (Ptr<const Packet> packet);
+  /**
+   * Write a trace of four readings, the third of an unknown sensor
+   * \param filename the name of the trace
+   */
+  void WriteTrace (std::string filename);
+  bool m_pcap; //!< true to replay a pcap trace, false for a binary trace
+  std::vector<Time> m_times; //!< the times of the readings
+  std::vector<uint32_t> m_sizes; //!< the sizes of the readings
+};
+
+LwsnTraceReplayTestCase::LwsnTraceReplayTestCase (bool pcap)
+  : TestCase (pcap ? "Replay a pcap trace" : "Replay a binary trace"),
+    m_pcap (pcap)
+{
+}
+
+void
+LwsnTraceReplayTestCase::Reading (Ptr<const Packet> packet)
+{
+  m_times.push_back (Simulator::Now ());
+  m_sizes.push_back (packet->GetSize ());
+}
+
+void
+LwsnTraceReplayTestCase::WriteTrace (std::string filename)
+{
+  const uint32_t seconds[] = { 5, 7, 7, 9 };
+  const uint32_t useconds[] = { 0, 0, 500000, 0 };
+  const uint16_t sids[] = { 1, 2, 9, 1 };
+  const uint32_t sizes[] = { 100, 60, 80, 40 };
+
+  if (m_pcap)
+    {
+      PcapFile f;
+      f.Open (filename, std::ios::out);
+      f.Init (147);
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          LwsnHeader header;
+          header.SetOsid (sids[i]);
+          Ptr<Packet> p = Create<Packet> (sizes[i] - header.GetSerializedSize ());
+          f.Write (seconds[i], useconds[i], header, p);
+        }
+      f.Close ();
+    }
+  else
+    {
+      std::ofstream f (filename.c_str (), std::ios::out | std::ios::binary);
+      LwsnTraceReplayApplication::WriteBinaryHeader (f);
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          Time t = Seconds (seconds[i]) + MicroSeconds (useconds[i]);
+          LwsnTraceReplayApplication::WriteBinaryRecord (f, t, sids[i], sizes[i]);
+        }
+    }
+}
+
+void
+LwsnTraceReplayTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename (m_pcap ? "replay.pcap" : "replay.trace");
+  WriteTrace (filename);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<LwsnTraceReplayApplication> app = CreateObject<LwsnTraceReplayApplication> ();
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      nodes.Get (i)->AddDevice (dev);
+      dev->SetNode (nodes.Get (i));
+      dev->SetChannel (channel);
+      dev->SetSid (i + 1);
+      app->AddSensor (dev);
+    }
+
+  app->SetAttribute ("Filename", StringValue (filename));
+  app->TraceConnectWithoutContext ("Tx", MakeCallback (&LwsnTraceReplayTestCase::Reading, this));
+  app->TraceConnectWithoutContext ("Drop", MakeCallback (&LwsnTraceReplayTestCase::Reading, this));
+  app->SetStartTime (Seconds (1));
+  nodes.Get (0)->AddApplication (app);
+
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (app->GetReplayed (), 3, "Unexpected number of readings replayed");
+  NS_TEST_ASSERT_MSG_EQ (app->GetSkipped (), 1, "The reading of the unknown sensor should be skipped");
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 3, "Every reading should be traced");
+  // the first record is replayed at the start time
+  NS_TEST_EXPECT_MSG_EQ (m_times[0], Seconds (1), "Unexpected time of the first reading");
+  NS_TEST_EXPECT_MSG_EQ (m_times[1], Seconds (3), "Unexpected time of the second reading");
+  NS_TEST_EXPECT_MSG_EQ (m_times[2], Seconds (5), "Unexpected time of the last reading");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[0], 100, "Unexpected size of the first reading");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[1], 60, "Unexpected size of the second reading");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[2], 40, "Unexpected size of the last reading");
+}
+
+class LwsnTraceReplayTestSuite : public TestSuite
+{
+public:
+  LwsnTraceReplayTestSuite ()
+    : TestSuite ("lwsn-trace-replay", UNIT)
+  {
+    AddTestCase (new LwsnTraceReplayTestCase (false), TestCase::QUICK);
+    AddTestCase (new LwsnTraceReplayTestCase (true), TestCase::QUICK);
+  }
+} g_lwsnTraceReplayTestSuite;
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/output-stream-wrapper.h"
+
+using namespace ns3;
+
+class AsyncStreamTestCase : public TestCase
+{
+public:
+  AsyncStreamTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param filename the name of a file
+   * \returns the content of the file
+   */
+  std::string ReadFile (std::string filename);
+};
+
+AsyncStreamTestCase::AsyncStreamTestCase ()
+  : TestCase ("Check the writes of an output stream from a background thread")
+{
+}
+
+std::string
+AsyncStreamTestCase::ReadFile (std::string filename)
+{
+  std::ifstream f (filename.c_str ());
+  std::ostringstream content;
+  content << f.rdbuf ();
+  return content.str ();
+}
+
+void
+AsyncStreamTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("async.tr");
+  std::ostringstream expected;
+  {
+    Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (filename, std::ios::out);
+    *stream->GetStream () << "header" << std::endl;
+    expected << "header" << std::endl;
+    // blocks smaller than a line, so that the writer thread is waited for
+    stream->EnableAsyncWrite (16, 2);
+    for (uint32_t i = 0; i < 1000; i++)
+      {
+        *stream->GetStream () << "+ " << i << " ns3::Packet line " << i << std::endl;
+        expected << "+ " << i << " ns3::Packet line " << i << std::endl;
+      }
+    stream->Flush ();
+    NS_TEST_EXPECT_MSG_EQ (ReadFile (filename), expected.str (), "Every line should be written at Flush");
+
+    *stream->GetStream () << "last" << std::endl;
+    expected << "last" << std::endl;
+  }
+  // the wrapper is kept alive by the flush at Simulator::Destroy
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (ReadFile (filename), expected.str (), "Every line should be written at Simulator::Destroy");
+}
+
+class OutputStreamWrapperTestSuite : public TestSuite
+{
+public:
+  OutputStreamWrapperTestSuite ()
+    : TestSuite ("output-stream-wrapper", UNIT)
+  {
+    AddTestCase (new AsyncStreamTestCase, TestCase::QUICK);
+  }
+} g_outputStreamWrapperTestSuite;
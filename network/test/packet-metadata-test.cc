@@ -823,6 +823,65 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 //-----------------------------------------------------------------------------
+class PacketMetadataSamplingTest : public TestCase {
+public:
+  PacketMetadataSamplingTest ();
+  virtual void DoRun (void);
+private:
+  static bool IsOdd (uint64_t uid);
+};
+
+PacketMetadataSamplingTest::PacketMetadataSamplingTest ()
+  : TestCase ("Sampled packet metadata")
+{
+}
+
+bool
+PacketMetadataSamplingTest::IsOdd (uint64_t uid)
+{
+  return uid % 2 == 1;
+}
+
+void
+PacketMetadataSamplingTest::DoRun (void)
+{
+  PacketMetadata::EnableSampling (4);
+  uint32_t recorded = 0;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (10);
+      ADD_HEADER (p, 2);
+      NS_TEST_EXPECT_MSG_EQ (p->IsPrintable (), p->GetUid () % 4 == 0, "Unexpected sampling");
+      if (p->IsPrintable ())
+        {
+          recorded++;
+          PacketMetadata::ItemIterator k = p->BeginItem ();
+          NS_TEST_EXPECT_MSG_EQ (k.Next ().currentSize, 2, "Missing header in a sampled packet");
+          NS_TEST_EXPECT_MSG_EQ (k.Next ().currentSize, 10, "Missing payload in a sampled packet");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (p->BeginItem ().HasNext (), false, "Metadata of a packet not sampled");
+        }
+      REM_HEADER (p, 2);
+      NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "Headers should work without metadata");
+    }
+  NS_TEST_EXPECT_MSG_EQ (recorded, 2, "One packet in four should be recorded");
+
+  PacketMetadata::EnableSampling (MakeCallback (&PacketMetadataSamplingTest::IsOdd));
+  Ptr<Packet> p1 = Create<Packet> (10);
+  Ptr<Packet> p2 = Create<Packet> (10);
+  NS_TEST_EXPECT_MSG_EQ (p1->IsPrintable () != p2->IsPrintable (), true, "The predicate should select one packet");
+  Ptr<Packet> printable = p1->IsPrintable () ? p1 : p2;
+  Ptr<Packet> other = p1->IsPrintable () ? p2 : p1;
+  printable->AddAtEnd (other);
+  NS_TEST_EXPECT_MSG_EQ (printable->IsPrintable (), false, "Partial metadata should be dropped");
+
+  PacketMetadata::EnableSampling (1);
+  p1 = Create<Packet> (10);
+  NS_TEST_EXPECT_MSG_EQ (p1->IsPrintable (), true, "All packets should be recorded again");
+}
+//-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
 {
 public:
@@ -833,6 +892,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataSamplingTest, TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
@@ -21,8 +21,11 @@
 #include "ns3/test.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/traced-callback.h"
 #include "ns3/packet.h"
+#include "ns3/packet-socket.h"
+#include "ns3/packet-socket-factory.h"
 #include "ns3/packet-socket-helper.h"
 #include "ns3/packet-socket-client.h"
 #include "ns3/packet-socket-server.h"
@@ -114,6 +117,97 @@ PacketSocketAppsTest::DoRun (void)
 }
 
 
+class PacketSocketBatchTest : public TestCase
+{
+  bool m_coalesce;
+  uint32_t m_notifications;
+  uint32_t m_receivedPacketNumber;
+
+public:
+  virtual void DoRun (void);
+  PacketSocketBatchTest (bool coalesce);
+
+  void DataRecv (Ptr<Socket> socket);
+  void ReceiveBurst (Ptr<SimpleNetDevice> dev, Ptr<SimpleNetDevice> from);
+};
+
+PacketSocketBatchTest::PacketSocketBatchTest (bool coalesce)
+  : TestCase (coalesce ? "Packet Socket batched receive, coalesced notifications"
+              : "Packet Socket batched receive, one notification per packet")
+{
+  m_coalesce = coalesce;
+  m_notifications = 0;
+  m_receivedPacketNumber = 0;
+}
+
+void
+PacketSocketBatchTest::DataRecv (Ptr<Socket> socket)
+{
+  m_notifications++;
+  std::vector<std::pair<Ptr<Packet>, Address> > batch;
+  while (DynamicCast<PacketSocket> (socket)->RecvBatch (4, batch) > 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((batch.size () <= 4), true, "Batch larger than requested");
+      m_receivedPacketNumber += batch.size ();
+      batch.clear ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (socket->GetRxAvailable (), 0, "Receive queue not drained");
+}
+
+void
+PacketSocketBatchTest::ReceiveBurst (Ptr<SimpleNetDevice> dev, Ptr<SimpleNetDevice> from)
+{
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      dev->Receive (Create<Packet> (100), 1, Mac48Address::GetBroadcast (),
+                    Mac48Address::ConvertFrom (from->GetAddress ()));
+    }
+}
+
+void
+PacketSocketBatchTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (nodes);
+
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  nodes.Get (0)->AddDevice (rxDev);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  rxDev->SetChannel (channel);
+  txDev->SetChannel (channel);
+  rxDev->SetNode (nodes.Get (0));
+
+  PacketSocketAddress socketAddr;
+  socketAddr.SetSingleDevice (rxDev->GetIfIndex ());
+  socketAddr.SetProtocol (1);
+
+  Ptr<Socket> socket = Socket::CreateSocket (nodes.Get (0), PacketSocketFactory::GetTypeId ());
+  socket->SetAttribute ("CoalesceDataRecv", BooleanValue (m_coalesce));
+  socket->Bind (socketAddr);
+  socket->SetRecvCallback (MakeCallback (&PacketSocketBatchTest::DataRecv, this));
+
+  // a burst of packets delivered within a single event
+  Simulator::Schedule (Seconds (1), &PacketSocketBatchTest::ReceiveBurst, this, rxDev, txDev);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketNumber, 10, "Number of packet received");
+  if (m_coalesce)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_notifications, 1, "Number of notifications");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_notifications, 10, "Number of notifications");
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 class PacketSocketAppsTestSuite : public TestSuite
@@ -122,5 +216,7 @@ public:
   PacketSocketAppsTestSuite () : TestSuite ("packet-socket-apps", UNIT)
   {
     AddTestCase (new PacketSocketAppsTest, TestCase::QUICK);
+    AddTestCase (new PacketSocketBatchTest (false), TestCase::QUICK);
+    AddTestCase (new PacketSocketBatchTest (true), TestCase::QUICK);
   }
 } g_packetSocketAppsTestSuite;
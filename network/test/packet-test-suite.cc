@@ -19,6 +19,8 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -509,6 +511,24 @@ PacketTest::DoRun (void)
 #endif
   }
 
+  /* Test prepending headers to a packet with byte tags added
+   * between the cuts.
+   */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<25> ());
+    tmp->RemoveAtStart (50);
+    tmp->AddHeader (ATestHeader<10> ());
+    CHECK (tmp, 1, E (25, 10, 60));
+    tmp->AddByteTag (ATestTag<20> ());
+    CHECK (tmp, 2, E (25, 10, 60), E (20, 0, 60));
+    tmp->RemoveAtStart (30);
+    tmp->AddHeader (ATestHeader<10> ());
+    CHECK (tmp, 2, E (25, 10, 40), E (20, 10, 40));
+    tmp->AddHeader (ATestHeader<10> ());
+    CHECK (tmp, 2, E (25, 20, 50), E (20, 20, 50));
+  }
+
   /* Test reducing tagged packet size and increasing it back. */
   {
     Ptr<Packet> tmp = Create<Packet> (0);
@@ -727,6 +747,26 @@ PacketTagListTest::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (ref.Peek (t10), false, "missing tag");
   }
 
+  { // Inline slots
+    std::cout << GetName () << "check inline tags spill into the list"
+              << std::endl;
+    NS_TEST_EXPECT_MSG_EQ (ref.GetNInlineTags (), PacketTagList::INLINE_TAGS,
+                           "inline slots should be full");
+    NS_TEST_EXPECT_MSG_EQ ((ref.Head () != 0), true, "tags should have spilled");
+    PacketTagList ptl;
+    ptl.Add (t1);
+    NS_TEST_EXPECT_MSG_EQ (ptl.GetNInlineTags (), 1, "tag should be inline");
+    NS_TEST_EXPECT_MSG_EQ ((ptl.Head () == 0), true, "no tag should have spilled");
+    PacketTagList copy (ptl);
+    copy.Add (t2);
+    CheckRef (copy, t1, "inline copy");
+    CheckRef (copy, t2, "inline copy");
+    CheckRef (ptl, t2, "inline orig", true);
+    copy.Remove (t1);
+    CheckRef (ptl, t1, "inline orig");
+    CheckRef (copy, t1, "inline copy", true);
+  }
+
   { // Copy ctor, assignment
     std::cout << GetName () << "check copy and assignment" << std::endl;
     { PacketTagList ptl (ref);
@@ -847,6 +887,132 @@ PacketTagListTest::DoRun (void)
     
 }
 
+//-----------------------------------------------------------------------------
+class PacketPoolTest : public TestCase
+{
+public:
+  PacketPoolTest ();
+private:
+  void DoRun (void);
+};
+
+PacketPoolTest::PacketPoolTest ()
+  : TestCase ("PacketPoolTest: check that packet memory is recycled")
+{
+}
+
+void
+PacketPoolTest::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  // make sure the pool is not empty
+  p->Copy ();
+
+  Packet::ResetPoolStatistics ();
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Ptr<Packet> copy = p->Copy ();
+      NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 100, "The copy should have the size of the original");
+    }
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetPoolHits (), 10, "Every copy should reuse the memory of the previous one");
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetPoolMisses (), 0, "No copy should miss the pool");
+
+  Ptr<Packet> a = Create<Packet> (10);
+  Ptr<Packet> b = Create<Packet> (10);
+  NS_TEST_EXPECT_MSG_NE (a->GetUid (), b->GetUid (), "Pooled packets should have distinct uids");
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetPoolHits () + Packet::GetPoolMisses (), 12, "Every allocation should be counted");
+}
+
+//-----------------------------------------------------------------------------
+class PacketHeadroomTest : public TestCase
+{
+public:
+  PacketHeadroomTest ();
+private:
+  void DoRun (void);
+};
+
+PacketHeadroomTest::PacketHeadroomTest ()
+  : TestCase ("PacketHeadroomTest: check packets created with room for headers")
+{
+}
+
+void
+PacketHeadroomTest::DoRun (void)
+{
+  Buffer::ResetHeadroomMisses ();
+  Ptr<Packet> a = Packet::CreateWithHeadroom (100, 16);
+  Ptr<Packet> b = Packet::CreateWithHeadroom (100, 16);
+  NS_TEST_EXPECT_MSG_EQ (a->GetSize (), 100, "The packet should have the requested size");
+  NS_TEST_EXPECT_MSG_NE (a->GetUid (), b->GetUid (), "Packets should have distinct uids");
+  a->AddHeader (ATestHeader<16> ());
+  NS_TEST_EXPECT_MSG_EQ (a->GetSize (), 116, "The header should be added");
+  NS_TEST_EXPECT_MSG_EQ (Buffer::GetHeadroomMisses (), 0, "The header should fit in the headroom");
+}
+
+//-----------------------------------------------------------------------------
+class PacketThreadTest : public TestCase
+{
+public:
+  PacketThreadTest ();
+private:
+  void DoRun (void);
+  /// Create, copy and fragment packets as a small simulation would
+  void Replicate (void);
+  uint64_t m_firstUid[2];  //!< uid of the first packet of each thread
+  uint64_t m_poolHits[2];  //!< packet pool hits of each thread
+  uint32_t m_index;        //!< index of the next thread
+  SystemMutex m_mutex;     //!< protects m_index
+};
+
+PacketThreadTest::PacketThreadTest ()
+  : TestCase ("PacketThreadTest: check that threads have their own packet core")
+{
+}
+
+void
+PacketThreadTest::Replicate (void)
+{
+  uint32_t index;
+  {
+    CriticalSection cs (m_mutex);
+    index = m_index++;
+  }
+  Ptr<Packet> p = Create<Packet> (1000);
+  m_firstUid[index] = p->GetUid ();
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      Ptr<Packet> copy = p->Copy ();
+      copy->AddHeader (ATestHeader<10> ());
+      copy->AddByteTag (ATestTag<2> ());
+      copy->AddPacketTag (ATestTag<3> ());
+      Ptr<Packet> fragment = copy->CreateFragment (5, 500);
+      fragment->AddAtEnd (copy);
+    }
+  m_poolHits[index] = Packet::GetPoolHits ();
+}
+
+void
+PacketThreadTest::DoRun (void)
+{
+  Packet::ResetPoolStatistics ();
+  m_index = 0;
+  Ptr<SystemThread> threads[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      threads[i] = Create<SystemThread> (MakeCallback (&PacketThreadTest::Replicate, this));
+      threads[i]->Start ();
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      threads[i]->Join ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_firstUid[0], m_firstUid[1], "Each thread should number its packets from the start");
+  NS_TEST_EXPECT_MSG_GT (m_poolHits[0], 0, "Each thread should reuse its own packets");
+  NS_TEST_EXPECT_MSG_GT (m_poolHits[1], 0, "Each thread should reuse its own packets");
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetPoolHits (), 0, "The threads should not use the pool of this thread");
+}
+
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
@@ -859,6 +1025,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketPoolTest, TestCase::QUICK);
+  AddTestCase (new PacketHeadroomTest, TestCase::QUICK);
+  AddTestCase (new PacketThreadTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -21,8 +21,11 @@
 
 #include <cstring>
 #include <iostream>
+#include <sstream>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/ptr.h"
+#include "ns3/packet.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/packetbb.h"
@@ -42,6 +45,11 @@ protected:
 private:
   void TestSerialize (void);
   void TestDeserialize (void);
+  void TestView (void);
+  void TestBuilder (void);
+  void CheckTlv (Ptr<PbbTlv> tlv, PbbTlvView view);
+  void CheckMessage (Ptr<PbbMessage> message, PbbMessageView view);
+  void CheckAddressBlock (Ptr<PbbAddressBlock> block, PbbAddressBlockView view);
 
   Ptr<PbbPacket> m_refPacket;
   Buffer m_refBuffer;
@@ -67,6 +75,8 @@ PbbTestCase::DoRun (void)
 {
   TestSerialize ();
   TestDeserialize ();
+  TestView ();
+  TestBuilder ();
 }
 
 void
@@ -99,6 +109,305 @@ PbbTestCase::TestDeserialize (void)
                                       "deserialization failed, objects do not match");
 }
 
+void
+PbbTestCase::CheckTlv (Ptr<PbbTlv> tlv, PbbTlvView view)
+{
+  NS_TEST_ASSERT_MSG_EQ (view.GetType (), tlv->GetType (), "view failed, TLV types differ");
+  NS_TEST_ASSERT_MSG_EQ (view.HasTypeExt (), tlv->HasTypeExt (), "view failed, TLV type extensions differ");
+  if (tlv->HasTypeExt ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetTypeExt (), tlv->GetTypeExt (), "view failed, TLV type extensions differ");
+    }
+  NS_TEST_ASSERT_MSG_EQ (view.HasValue (), tlv->HasValue (), "view failed, TLV values differ");
+  if (tlv->HasValue ())
+    {
+      Buffer value = tlv->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (view.GetValueSize (), value.GetSize (), "view failed, TLV value sizes differ");
+      std::vector<uint8_t> bytes (view.GetValueSize () + 1);
+      view.GetValue ().Read (&bytes[0], view.GetValueSize ());
+      NS_TEST_ASSERT_MSG_EQ (memcmp (&bytes[0], value.PeekData (), value.GetSize ()), 0,
+                             "view failed, TLV values differ");
+    }
+}
+
+void
+PbbTestCase::CheckAddressBlock (Ptr<PbbAddressBlock> block, PbbAddressBlockView view)
+{
+  NS_TEST_ASSERT_MSG_EQ ((int)view.GetNAddresses (), block->AddressSize (), "view failed, address counts differ");
+  PbbAddressIterator addresses = view.GetAddressIterator ();
+  for (PbbAddressBlock::ConstAddressIterator i = block->AddressBegin (); i != block->AddressEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (addresses.HasNext (), true, "view failed, missing address");
+      NS_TEST_ASSERT_MSG_EQ (addresses.Next (), *i, "view failed, addresses differ");
+    }
+  NS_TEST_ASSERT_MSG_EQ (addresses.HasNext (), false, "view failed, extra address");
+
+  NS_TEST_ASSERT_MSG_EQ ((int)view.GetNPrefixes (), block->PrefixSize (), "view failed, prefix counts differ");
+  uint8_t index = 0;
+  for (PbbAddressBlock::ConstPrefixIterator i = block->PrefixBegin (); i != block->PrefixEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetPrefix (index++), *i, "view failed, prefixes differ");
+    }
+
+  PbbTlvIterator tlvs = view.GetTlvIterator ();
+  for (PbbAddressBlock::ConstTlvIterator i = block->TlvBegin (); i != block->TlvEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (tlvs.HasNext (), true, "view failed, missing address TLV");
+      PbbTlvView tlv = tlvs.Next ();
+      CheckTlv (*i, tlv);
+      NS_TEST_ASSERT_MSG_EQ (tlv.HasIndexStart (), (*i)->HasIndexStart (), "view failed, TLV start indexes differ");
+      if ((*i)->HasIndexStart ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (tlv.GetIndexStart (), (*i)->GetIndexStart (), "view failed, TLV start indexes differ");
+        }
+      NS_TEST_ASSERT_MSG_EQ (tlv.HasIndexStop (), (*i)->HasIndexStop (), "view failed, TLV stop indexes differ");
+      if ((*i)->HasIndexStop ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (tlv.GetIndexStop (), (*i)->GetIndexStop (), "view failed, TLV stop indexes differ");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (tlvs.HasNext (), false, "view failed, extra address TLV");
+}
+
+void
+PbbTestCase::CheckMessage (Ptr<PbbMessage> message, PbbMessageView view)
+{
+  NS_TEST_ASSERT_MSG_EQ (view.GetType (), message->GetType (), "view failed, message types differ");
+  NS_TEST_ASSERT_MSG_EQ (view.HasOriginatorAddress (), message->HasOriginatorAddress (), "view failed, originators differ");
+  if (message->HasOriginatorAddress ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetOriginatorAddress (), message->GetOriginatorAddress (), "view failed, originators differ");
+    }
+  NS_TEST_ASSERT_MSG_EQ (view.HasHopLimit (), message->HasHopLimit (), "view failed, hop limits differ");
+  if (message->HasHopLimit ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetHopLimit (), message->GetHopLimit (), "view failed, hop limits differ");
+    }
+  NS_TEST_ASSERT_MSG_EQ (view.HasHopCount (), message->HasHopCount (), "view failed, hop counts differ");
+  if (message->HasHopCount ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetHopCount (), message->GetHopCount (), "view failed, hop counts differ");
+    }
+  NS_TEST_ASSERT_MSG_EQ (view.HasSequenceNumber (), message->HasSequenceNumber (), "view failed, sequence numbers differ");
+  if (message->HasSequenceNumber ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetSequenceNumber (), message->GetSequenceNumber (), "view failed, sequence numbers differ");
+    }
+
+  PbbTlvIterator tlvs = view.GetTlvIterator ();
+  for (PbbMessage::ConstTlvIterator i = message->TlvBegin (); i != message->TlvEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (tlvs.HasNext (), true, "view failed, missing message TLV");
+      CheckTlv (*i, tlvs.Next ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (tlvs.HasNext (), false, "view failed, extra message TLV");
+
+  PbbAddressBlockIterator blocks = view.GetAddressBlockIterator ();
+  for (PbbMessage::ConstAddressBlockIterator i = message->AddressBlockBegin (); i != message->AddressBlockEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (blocks.HasNext (), true, "view failed, missing address block");
+      CheckAddressBlock (*i, blocks.Next ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (blocks.HasNext (), false, "view failed, extra address block");
+}
+
+void
+PbbTestCase::TestView (void)
+{
+  PbbPacketView view;
+  uint32_t numbytes = view.Deserialize (m_refBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (numbytes, m_refBuffer.GetSize (),
+                         "view failed, did not use all bytes");
+
+  NS_TEST_ASSERT_MSG_EQ (view.GetVersion (), m_refPacket->GetVersion (), "view failed, versions differ");
+  NS_TEST_ASSERT_MSG_EQ (view.HasSequenceNumber (), m_refPacket->HasSequenceNumber (),
+                         "view failed, sequence numbers differ");
+  if (m_refPacket->HasSequenceNumber ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (view.GetSequenceNumber (), m_refPacket->GetSequenceNumber (),
+                             "view failed, sequence numbers differ");
+    }
+
+  PbbTlvIterator tlvs = view.GetTlvIterator ();
+  for (PbbPacket::ConstTlvIterator i = m_refPacket->TlvBegin (); i != m_refPacket->TlvEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (tlvs.HasNext (), true, "view failed, missing packet TLV");
+      CheckTlv (*i, tlvs.Next ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (tlvs.HasNext (), false, "view failed, extra packet TLV");
+
+  PbbMessageIterator messages = view.GetMessageIterator ();
+  for (PbbPacket::ConstMessageIterator i = m_refPacket->MessageBegin (); i != m_refPacket->MessageEnd (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (messages.HasNext (), true, "view failed, missing message");
+      CheckMessage (*i, messages.Next ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (messages.HasNext (), false, "view failed, extra message");
+
+  Buffer newBuffer;
+  newBuffer.AddAtStart (view.GetSerializedSize ());
+  view.Serialize (newBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (newBuffer.GetSize (), m_refBuffer.GetSize (),
+                         "view serialization failed, buffers have different sizes");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (newBuffer.PeekData (), m_refBuffer.PeekData (), newBuffer.GetSize ()), 0,
+                         "view serialization failed, buffers differ");
+}
+
+void
+PbbTestCase::TestBuilder (void)
+{
+  PbbPacketBuilder builder;
+  /* Build twice: the second packet reuses the memory of the first one. */
+  for (int round = 0; round < 2; round++)
+    {
+      builder.Clear ();
+      if (m_refPacket->HasSequenceNumber ())
+        {
+          builder.SetSequenceNumber (m_refPacket->GetSequenceNumber ());
+        }
+      for (PbbPacket::ConstTlvIterator i = m_refPacket->TlvBegin (); i != m_refPacket->TlvEnd (); i++)
+        {
+          builder.AddTlv ((*i)->GetType ());
+          if ((*i)->HasTypeExt ())
+            {
+              builder.SetTlvTypeExt ((*i)->GetTypeExt ());
+            }
+          if ((*i)->HasValue ())
+            {
+              Buffer value = (*i)->GetValue ();
+              builder.SetTlvValue (value.PeekData (), value.GetSize ());
+            }
+        }
+      for (PbbPacket::ConstMessageIterator m = m_refPacket->MessageBegin (); m != m_refPacket->MessageEnd (); m++)
+        {
+          Ptr<PbbMessage> message = *m;
+          builder.AddMessage (message->GetType (), DynamicCast<PbbMessageIpv6> (message) != 0 ? IPV6 : IPV4);
+          if (message->HasOriginatorAddress ())
+            {
+              builder.SetOriginatorAddress (message->GetOriginatorAddress ());
+            }
+          if (message->HasHopLimit ())
+            {
+              builder.SetHopLimit (message->GetHopLimit ());
+            }
+          if (message->HasHopCount ())
+            {
+              builder.SetHopCount (message->GetHopCount ());
+            }
+          if (message->HasSequenceNumber ())
+            {
+              builder.SetMessageSequenceNumber (message->GetSequenceNumber ());
+            }
+          for (PbbMessage::ConstTlvIterator i = message->TlvBegin (); i != message->TlvEnd (); i++)
+            {
+              builder.AddTlv ((*i)->GetType ());
+              if ((*i)->HasTypeExt ())
+                {
+                  builder.SetTlvTypeExt ((*i)->GetTypeExt ());
+                }
+              if ((*i)->HasValue ())
+                {
+                  Buffer value = (*i)->GetValue ();
+                  builder.SetTlvValue (value.PeekData (), value.GetSize ());
+                }
+            }
+          for (PbbMessage::ConstAddressBlockIterator b = message->AddressBlockBegin (); b != message->AddressBlockEnd (); b++)
+            {
+              builder.AddAddressBlock ();
+              for (PbbAddressBlock::ConstAddressIterator i = (*b)->AddressBegin (); i != (*b)->AddressEnd (); i++)
+                {
+                  builder.AddAddress (*i);
+                }
+              for (PbbAddressBlock::ConstPrefixIterator i = (*b)->PrefixBegin (); i != (*b)->PrefixEnd (); i++)
+                {
+                  builder.AddPrefix (*i);
+                }
+              for (PbbAddressBlock::ConstTlvIterator i = (*b)->TlvBegin (); i != (*b)->TlvEnd (); i++)
+                {
+                  builder.AddTlv ((*i)->GetType ());
+                  if ((*i)->HasTypeExt ())
+                    {
+                      builder.SetTlvTypeExt ((*i)->GetTypeExt ());
+                    }
+                  if ((*i)->HasIndexStart ())
+                    {
+                      builder.SetTlvIndexStart ((*i)->GetIndexStart ());
+                    }
+                  if ((*i)->HasIndexStop ())
+                    {
+                      builder.SetTlvIndexStop ((*i)->GetIndexStop ());
+                    }
+                  if ((*i)->HasValue ())
+                    {
+                      Buffer value = (*i)->GetValue ();
+                      builder.SetTlvValue (value.PeekData (), value.GetSize ());
+                      builder.SetTlvMultivalue ((*i)->IsMultivalue ());
+                    }
+                }
+            }
+        }
+
+      Buffer newBuffer;
+      newBuffer.AddAtStart (builder.GetSerializedSize ());
+      builder.Serialize (newBuffer.Begin ());
+      NS_TEST_ASSERT_MSG_EQ (newBuffer.GetSize (), m_refBuffer.GetSize (),
+                             "builder failed, buffers have different sizes");
+      NS_TEST_ASSERT_MSG_EQ (memcmp (newBuffer.PeekData (), m_refBuffer.PeekData (), newBuffer.GetSize ()), 0,
+                             "builder failed, buffers differ");
+    }
+}
+
+class PbbMetadataTestCase : public TestCase
+{
+public:
+  PbbMetadataTestCase (void);
+
+protected:
+  virtual void DoRun (void);
+};
+
+PbbMetadataTestCase::PbbMetadataTestCase (void)
+  : TestCase ("PacketBB headers with the packet metadata checked")
+{
+}
+
+void
+PbbMetadataTestCase::DoRun (void)
+{
+  Packet::EnableChecking ();
+
+  PbbPacket pbb;
+  pbb.SetSequenceNumber (7);
+  Ptr<PbbMessageIpv4> message = Create<PbbMessageIpv4> ();
+  message->SetType (1);
+  message->SetOriginatorAddress (Ipv4Address ("10.0.0.1"));
+  pbb.MessagePushBack (message);
+
+  /* The view reads the bytes of a PbbPacket. */
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (pbb);
+  PbbPacketView view;
+  NS_TEST_ASSERT_MSG_EQ (packet->RemoveHeader (view), pbb.GetSerializedSize (),
+                         "view failed, did not use all bytes");
+  NS_TEST_ASSERT_MSG_EQ (view.GetSequenceNumber (), 7, "view failed, sequence numbers differ");
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 0, "view failed, bytes left in the packet");
+
+  /* A built packet is printed, and removed, as a PbbPacket. */
+  PbbPacketBuilder builder;
+  builder.SetSequenceNumber (7);
+  builder.AddMessage (1, IPV4);
+  builder.SetOriginatorAddress (Ipv4Address ("10.0.0.1"));
+  packet->AddHeader (builder);
+  std::ostringstream printed;
+  packet->Print (printed);
+  NS_TEST_ASSERT_MSG_NE (printed.str ().find ("PbbPacket {"), std::string::npos,
+                         "builder failed, packet not printed as a PbbPacket");
+  PbbPacket removed;
+  NS_TEST_ASSERT_MSG_EQ (packet->RemoveHeader (removed), builder.GetSerializedSize (),
+                         "builder failed, did not use all bytes");
+  NS_TEST_ASSERT_MSG_EQ (removed, pbb, "builder failed, objects do not match");
+}
+
 class PbbTestSuite : public TestSuite
 {
 public:
@@ -3818,6 +4127,8 @@ PbbTestSuite::PbbTestSuite ()
     };
     AddTestCase (new PbbTestCase ("37", packet, buffer, sizeof(buffer)), TestCase::QUICK);
   }
+
+  AddTestCase (new PbbMetadataTestCase, TestCase::QUICK);
 }
 
 static PbbTestSuite pbbTestSuite;
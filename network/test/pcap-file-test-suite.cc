@@ -21,10 +21,16 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <vector>
+#include <iterator>
+#include <algorithm>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/pcap-file-reader.h"
 
 using namespace ns3;
 
@@ -1121,6 +1127,313 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that the records written by the background thread
+// are the same as the ones written synchronously
+// ===========================================================================
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Write the known packets to a file
+   * \param filename the file name
+   * \param blockSize the size of the blocks of the writer thread, or 0
+   */
+  void WriteKnownPackets (std::string filename, uint32_t blockSize);
+
+  std::string m_syncFilename;  //!< file written synchronously
+  std::string m_asyncFilename; //!< file written by the writer thread
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile::EnableAsyncWrite writes the same file")
+{
+}
+
+void
+AsyncWriteTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_syncFilename = CreateTempDirFilename (filename.str () + "-sync.pcap");
+  m_asyncFilename = CreateTempDirFilename (filename.str () + "-async.pcap");
+}
+
+void
+AsyncWriteTestCase::DoTeardown (void)
+{
+  remove (m_syncFilename.c_str ());
+  remove (m_asyncFilename.c_str ());
+}
+
+void
+AsyncWriteTestCase::WriteKnownPackets (std::string filename, uint32_t blockSize)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  if (blockSize > 0)
+    {
+      // two small blocks: the writer thread applies back-pressure often
+      f.EnableAsyncWrite (blockSize, 2);
+    }
+  f.Init (1, N_PACKET_BYTES);
+  for (uint32_t round = 0; round < 100; ++round)
+    {
+      for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+          PacketEntry const & p = knownPackets[i];
+          f.Write (p.tsSec + round, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+        }
+    }
+  f.Flush ();
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  f.Close ();
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  WriteKnownPackets (m_syncFilename, 0);
+  WriteKnownPackets (m_asyncFilename, 100);
+
+  uint32_t sec (0), usec (0), packets (0);
+  bool diff = PcapFile::Diff (m_syncFilename, m_asyncFilename, sec, usec, packets);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "The writer thread must write the same records");
+  NS_TEST_EXPECT_MSG_EQ (packets, 100 * N_KNOWN_PACKETS, "The writer thread must write all the records");
+}
+
+// ===========================================================================
+// Test case to make sure that PcapngFile writes the packets of several
+// interfaces into a well formed pcapng file
+// ===========================================================================
+class PcapngTestCase : public TestCase
+{
+public:
+  PcapngTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< the test file name
+};
+
+PcapngTestCase::PcapngTestCase ()
+  : TestCase ("Check that PcapngFile multiplexes interfaces in a single file")
+{
+}
+
+void
+PcapngTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcapng");
+}
+
+void
+PcapngTestCase::DoTeardown (void)
+{
+  remove (m_testFilename.c_str ());
+}
+
+void
+PcapngTestCase::DoRun (void)
+{
+  Ptr<PcapngFile> f = Create<PcapngFile> ();
+  f->Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (f->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  uint32_t snapLens[2] = { N_PACKET_BYTES, 2 * N_PACKET_BYTES - 3 };
+  NS_TEST_ASSERT_MSG_EQ (f->AddInterface (1, snapLens[0], "node-0", false), 0, "First interface");
+  NS_TEST_ASSERT_MSG_EQ (f->AddInterface (113, snapLens[1], "node-1", true), 1, "Second interface");
+  NS_TEST_ASSERT_MSG_EQ (f->GetNInterfaces (), 2, "Two interfaces");
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      f->Write (i % 2, p.tsSec * 1000000ULL + p.tsUsec, (uint8_t const *)p.data, p.origLen);
+    }
+  f->Close ();
+  NS_TEST_ASSERT_MSG_EQ (f->Fail (), false, "Write must not fail");
+
+  std::ifstream in (m_testFilename.c_str (), std::ios::binary);
+  std::vector<uint8_t> data ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  uint32_t offset = 0;
+  uint32_t nInterfaces = 0;
+  uint32_t nPackets = 0;
+  while (offset + 12 <= data.size ())
+    {
+      uint32_t type, length, trailer;
+      memcpy (&type, &data[offset], 4);
+      memcpy (&length, &data[offset + 4], 4);
+      NS_TEST_ASSERT_MSG_EQ (length % 4, 0, "Blocks are 32 bit aligned");
+      NS_TEST_ASSERT_MSG_EQ (offset + length <= data.size (), true, "Block " << type << " is truncated");
+      memcpy (&trailer, &data[offset + length - 4], 4);
+      NS_TEST_ASSERT_MSG_EQ (trailer, length, "Block " << type << " trailer");
+      if (offset == 0)
+        {
+          uint32_t magic;
+          memcpy (&magic, &data[offset + 8], 4);
+          NS_TEST_EXPECT_MSG_EQ (type, 0x0a0d0d0a, "The file starts with a section header");
+          NS_TEST_EXPECT_MSG_EQ (magic, 0x1a2b3c4d, "Byte-order magic");
+        }
+      else if (type == 1)
+        {
+          uint32_t snapLen;
+          memcpy (&snapLen, &data[offset + 12], 4);
+          NS_TEST_EXPECT_MSG_EQ (snapLen, snapLens[nInterfaces], "Interface snap length");
+          nInterfaces++;
+        }
+      else if (type == 6)
+        {
+          PacketEntry const & p = knownPackets[nPackets];
+          uint32_t interface, tsHigh, tsLow, inclLen, origLen;
+          memcpy (&interface, &data[offset + 8], 4);
+          memcpy (&tsHigh, &data[offset + 12], 4);
+          memcpy (&tsLow, &data[offset + 16], 4);
+          memcpy (&inclLen, &data[offset + 20], 4);
+          memcpy (&origLen, &data[offset + 24], 4);
+          uint32_t expectedLen = std::min (p.origLen, snapLens[interface]);
+          NS_TEST_EXPECT_MSG_EQ (interface, nPackets % 2, "Packet " << nPackets << " interface");
+          NS_TEST_EXPECT_MSG_EQ (((uint64_t)tsHigh << 32) + tsLow, p.tsSec * 1000000ULL + p.tsUsec, "Packet " << nPackets << " timestamp");
+          NS_TEST_EXPECT_MSG_EQ (inclLen, expectedLen, "Packet " << nPackets << " captured length");
+          NS_TEST_EXPECT_MSG_EQ (origLen, p.origLen, "Packet " << nPackets << " original length");
+          NS_TEST_EXPECT_MSG_EQ (memcmp (&data[offset + 28], p.data, expectedLen), 0, "Packet " << nPackets << " data");
+          nPackets++;
+        }
+      offset += length;
+    }
+  NS_TEST_EXPECT_MSG_EQ (offset, data.size (), "The file is a sequence of blocks");
+  NS_TEST_EXPECT_MSG_EQ (nInterfaces, 2, "One description block per interface");
+  NS_TEST_EXPECT_MSG_EQ (nPackets, N_KNOWN_PACKETS, "One packet block per packet");
+}
+
+// ===========================================================================
+// Test case to make sure that the mapped reader indexes the records of a
+// file and gives random access to them, or reads them in order unindexed
+// ===========================================================================
+class FileReaderTestCase : public TestCase
+{
+public:
+  FileReaderTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< the test file name
+};
+
+FileReaderTestCase::FileReaderTestCase ()
+  : TestCase ("Check that PcapFileReader gives random and sequential access to the records")
+{
+}
+
+void
+FileReaderTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcap");
+}
+
+void
+FileReaderTestCase::DoTeardown (void)
+{
+  remove (m_testFilename.c_str ());
+}
+
+void
+FileReaderTestCase::DoRun (void)
+{
+  std::string filename = CreateDataDirFilename ("known.pcap");
+  PcapFileReader r;
+  NS_TEST_ASSERT_MSG_EQ (r.Open (filename), true, "Open (" << filename << ") returns error");
+  NS_TEST_ASSERT_MSG_EQ (r.GetNPackets (), N_KNOWN_PACKETS, "Every record is indexed");
+  NS_TEST_EXPECT_MSG_EQ (r.GetSwapMode (), false, "Known file is in host byte order");
+
+  // read the records backwards, to make sure they do not depend on each other
+  for (uint32_t i = N_KNOWN_PACKETS; i-- > 0; )
+    {
+      PacketEntry const & p = knownPackets[i];
+      PcapFileReader::Record record = r.GetRecord (i);
+      NS_TEST_EXPECT_MSG_EQ (record.m_tsSec, p.tsSec, "Record " << i << " seconds");
+      NS_TEST_EXPECT_MSG_EQ (record.m_tsUsec, p.tsUsec, "Record " << i << " microseconds");
+      NS_TEST_EXPECT_MSG_EQ (record.m_inclLen, p.inclLen, "Record " << i << " included length");
+      NS_TEST_EXPECT_MSG_EQ (record.m_origLen, p.origLen, "Record " << i << " original length");
+      NS_TEST_EXPECT_MSG_EQ (r.Seek (p.tsSec, p.tsUsec), i, "Seek to the time of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (r.Seek (p.tsSec, p.tsUsec + 1), i + 1, "Seek past the time of record " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (r.Seek (0, 0), 0, "Seek before the first record");
+  r.Close ();
+
+  //
+  // The same packets in the other byte order, followed by a truncated record
+  //
+  PcapFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"std::ios::out\") returns error");
+  f.Init (1, N_PACKET_BYTES, PcapFile::ZONE_DEFAULT, true);
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+    }
+  f.Close ();
+  std::ofstream out (m_testFilename.c_str (), std::ios::out | std::ios::binary | std::ios::app);
+  uint32_t partial[4] = { 0, 0, Swap (uint32_t (100)), Swap (uint32_t (100)) };
+  out.write ((const char *)partial, sizeof (partial));
+  out.close ();
+
+  NS_TEST_ASSERT_MSG_EQ (r.Open (m_testFilename), true, "Open (" << m_testFilename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (r.GetSwapMode (), true, "File should be byte swapped");
+  NS_TEST_EXPECT_MSG_EQ (r.GetSnapLen (), N_PACKET_BYTES, "Snap length");
+  NS_TEST_EXPECT_MSG_EQ (r.GetDataLinkType (), 1, "Data link type");
+  NS_TEST_ASSERT_MSG_EQ (r.GetNPackets (), N_KNOWN_PACKETS, "The truncated record should be ignored");
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      PcapFileReader::Record record = r.GetRecord (i);
+      NS_TEST_EXPECT_MSG_EQ (record.m_tsUsec, p.tsUsec, "Record " << i << " microseconds");
+      NS_TEST_EXPECT_MSG_EQ (record.m_inclLen, N_PACKET_BYTES, "Record " << i << " included length");
+      NS_TEST_EXPECT_MSG_EQ (record.m_origLen, p.origLen, "Record " << i << " original length");
+      NS_TEST_EXPECT_MSG_EQ (memcmp (record.m_data, p.data, N_PACKET_BYTES), 0, "Record " << i << " data");
+    }
+  r.Close ();
+
+  // the same records, in order and without an index
+  NS_TEST_ASSERT_MSG_EQ (r.OpenSequential (m_testFilename), true, "OpenSequential (" << m_testFilename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (r.GetNPackets (), 0, "The records should not be indexed");
+  PcapFileReader::Record record;
+  uint32_t n = 0;
+  while (r.ReadNext (record))
+    {
+      NS_TEST_ASSERT_MSG_LT (n, N_KNOWN_PACKETS, "Too many records");
+      PacketEntry const & p = knownPackets[n];
+      NS_TEST_EXPECT_MSG_EQ (record.m_tsUsec, p.tsUsec, "Record " << n << " microseconds");
+      NS_TEST_EXPECT_MSG_EQ (record.m_origLen, p.origLen, "Record " << n << " original length");
+      NS_TEST_EXPECT_MSG_EQ (memcmp (record.m_data, p.data, N_PACKET_BYTES), 0, "Record " << n << " data");
+      r.ReleaseRead ();
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, N_KNOWN_PACKETS, "The truncated record should end the reading");
+  r.Close ();
+
+  NS_TEST_EXPECT_MSG_EQ (r.Open (CreateDataDirFilename ("missing.pcap")), false, "Open of a missing file should fail");
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1138,6 +1451,9 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
+  AddTestCase (new PcapngTestCase, TestCase::QUICK);
+  AddTestCase (new FileReaderTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
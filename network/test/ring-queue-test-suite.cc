@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ring-queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/net-device.h"
+#include <vector>
+
+using namespace ns3;
+
+class RingQueueTestCase : public TestCase
+{
+public:
+  RingQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+RingQueueTestCase::RingQueueTestCase ()
+  : TestCase ("Sanity check on the ring queue implementation")
+{
+}
+void
+RingQueueTestCase::DoRun (void)
+{
+  Ptr<RingQueue> queue = CreateObject<RingQueue> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Capacity", UintegerValue (3)), true,
+                         "Verify that we can actually set the attribute");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 4, "The capacity should be rounded up to a power of two");
+
+  Ptr<Packet> p[5];
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      p[i] = Create<Packet> ();
+    }
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      queue->Enqueue (Create<QueueItem> (p[i]));
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), i + 1, "Unexpected number of packets in there");
+    }
+  queue->Enqueue (Create<QueueItem> (p[4])); // will be dropped
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 4, "There should be still four packets in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 1, "One packet should have been dropped");
+
+  Ptr<QueueItem> item;
+
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetPacket ()->GetUid (), p[0]->GetUid (), "Peek should return the first packet");
+
+  // go around the ring a few times
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          item = queue->Dequeue ();
+          NS_TEST_EXPECT_MSG_EQ ((item != 0), true, "I want to remove a packet");
+          NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->GetUid (), p[i]->GetUid (), "Packets should be dequeued in order");
+          queue->Enqueue (Create<QueueItem> (p[i]));
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 4, "There should be four packets in there");
+    }
+
+  queue->DequeueAll ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "There should be no packets in there");
+
+  item = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ ((item == 0), true, "There are really no packets in there");
+}
+
+class QueueItemFreeListTestCase : public TestCase
+{
+public:
+  QueueItemFreeListTestCase ();
+  virtual void DoRun (void);
+};
+
+QueueItemFreeListTestCase::QueueItemFreeListTestCase ()
+  : TestCase ("Check the recycling of the queue item memory")
+{
+}
+
+void
+QueueItemFreeListTestCase::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (10);
+
+  Ptr<QueueItem> item = Create<QueueItem> (p);
+  QueueItem *address = PeekPointer (item);
+  item = 0;
+  uint32_t size = QueueItem::GetFreeListSize ();
+  NS_TEST_EXPECT_MSG_GT (size, 0, "A released item should be kept for reuse");
+
+  item = Create<QueueItem> (p);
+  NS_TEST_EXPECT_MSG_EQ (PeekPointer (item), address, "The released storage should be reused");
+  NS_TEST_EXPECT_MSG_EQ (QueueItem::GetFreeListSize (), size - 1, "The reused block should leave the free list");
+  item = 0;
+
+  // release more items than the free list may keep
+  Ptr<RingQueue> queue = CreateObject<RingQueue> ();
+  queue->SetCapacity (2 * QueueItem::FREE_LIST_CAP);
+  std::vector<Ptr<QueueItem> > items;
+  for (uint32_t i = 0; i < QueueItem::FREE_LIST_CAP + 100; i++)
+    {
+      Ptr<QueueItem> qi = Create<QueueItem> (p);
+      items.push_back (qi);
+      queue->Enqueue (qi);
+    }
+  items.clear ();
+  queue->DequeueAll ();
+  queue->Dispose ();
+  NS_TEST_EXPECT_MSG_EQ (QueueItem::GetFreeListSize (), QueueItem::FREE_LIST_CAP,
+                         "The free list should not grow past its cap");
+}
+
+static class RingQueueTestSuite : public TestSuite
+{
+public:
+  RingQueueTestSuite ()
+    : TestSuite ("ring-queue", UNIT)
+  {
+    AddTestCase (new RingQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new QueueItemFreeListTestCase (), TestCase::QUICK);
+  }
+} g_ringQueueTestSuite;
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <queue>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/queue-limits.h"
+#include "ns3/net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+
+using namespace ns3;
+
+/**
+ * \brief A queue sending only the newest packet: the older ones are
+ * dropped from the head of the queue when a packet is dequeued.
+ */
+class NewestPacketQueue : public Queue
+{
+private:
+  virtual bool DoEnqueue (Ptr<QueueItem> item)
+  {
+    m_packets.push (item);
+    return true;
+  }
+  virtual Ptr<QueueItem> DoDequeue (void)
+  {
+    while (m_packets.size () > 1)
+      {
+        // Remove () updates the statistics of the base class and fires the Drop trace
+        Remove ();
+      }
+    Ptr<QueueItem> item = m_packets.front ();
+    m_packets.pop ();
+    return item;
+  }
+  virtual Ptr<QueueItem> DoRemove (void)
+  {
+    Ptr<QueueItem> item = m_packets.front ();
+    m_packets.pop ();
+    return item;
+  }
+  virtual Ptr<const QueueItem> DoPeek (void) const
+  {
+    return m_packets.front ();
+  }
+
+  std::queue<Ptr<QueueItem> > m_packets; //!< the packets
+};
+
+/**
+ * \brief Queue limits of a fixed number of bytes
+ */
+class FixedQueueLimits : public QueueLimits
+{
+public:
+  /**
+   * \param limit the number of bytes which can be outstanding
+   */
+  FixedQueueLimits (uint32_t limit)
+    : m_limit (limit),
+      m_queued (0),
+      m_completed (0)
+  {
+  }
+  virtual void Reset ()
+  {
+    m_queued = 0;
+    m_completed = 0;
+  }
+  virtual void Completed (uint32_t count)
+  {
+    NS_ASSERT (m_completed + count <= m_queued);
+    m_completed += count;
+  }
+  virtual int32_t Available () const
+  {
+    return static_cast<int32_t> (m_limit) - static_cast<int32_t> (GetOutstanding ());
+  }
+  virtual void Queued (uint32_t count)
+  {
+    m_queued += count;
+  }
+  /**
+   * \returns the number of bytes queued and not completed yet
+   */
+  uint32_t GetOutstanding (void) const
+  {
+    return m_queued - m_completed;
+  }
+
+private:
+  uint32_t m_limit;     //!< the number of bytes which can be outstanding
+  uint32_t m_queued;    //!< the number of bytes queued
+  uint32_t m_completed; //!< the number of bytes completed
+};
+
+class SimpleNetDeviceQueueLimitsTestCase : public TestCase
+{
+public:
+  SimpleNetDeviceQueueLimitsTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Send packets until the device stops the upper layer
+   */
+  void Fill (void);
+  /**
+   * Count the wake ups of the upper layer
+   */
+  void Wake (void);
+  Ptr<SimpleNetDevice> m_device; //!< the device under test
+  uint32_t m_wakes; //!< number of wake ups
+};
+
+SimpleNetDeviceQueueLimitsTestCase::SimpleNetDeviceQueueLimitsTestCase ()
+  : TestCase ("Check that the bytes dropped by the transmit queue are completed"),
+    m_wakes (0)
+{
+}
+
+void
+SimpleNetDeviceQueueLimitsTestCase::Fill (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_device->GetTxQueue ()->IsStopped (), false,
+                         "The device should have woken the upper layer");
+  uint32_t sent = 0;
+  while (m_device->Send (Create<Packet> (100), m_device->GetBroadcast (), 0))
+    {
+      sent++;
+    }
+  // the third packet leaves no room in the limits
+  NS_TEST_EXPECT_MSG_EQ (sent, 3, "Unexpected number of packets accepted");
+  NS_TEST_EXPECT_MSG_EQ (m_device->GetTxQueue ()->IsStopped (), true,
+                         "The device should stop the upper layer");
+}
+
+void
+SimpleNetDeviceQueueLimitsTestCase::Wake (void)
+{
+  m_wakes++;
+}
+
+void
+SimpleNetDeviceQueueLimitsTestCase::DoRun (void)
+{
+  m_device = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  m_device->SetAddress (Mac48Address::Allocate ());
+  m_device->SetChannel (channel);
+  m_device->SetSid (1);
+  Ptr<NewestPacketQueue> queue = CreateObject<NewestPacketQueue> ();
+  queue->SetMaxPackets (100);
+  m_device->SetQueue (queue);
+  Ptr<FixedQueueLimits> limits = CreateObject<FixedQueueLimits> (250);
+  m_device->SetTxQueueLimits (limits);
+  m_device->SetTxWakeCallback (MakeCallback (&SimpleNetDeviceQueueLimitsTestCase::Wake, this));
+
+  // the first packet is sent at once, the second one is dropped when
+  // the third one is dequeued
+  Simulator::Schedule (Seconds (0), &SimpleNetDeviceQueueLimitsTestCase::Fill, this);
+  Simulator::Schedule (Seconds (10), &SimpleNetDeviceQueueLimitsTestCase::Fill, this);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 2, "Unexpected number of drops");
+  NS_TEST_EXPECT_MSG_EQ (limits->GetOutstanding (), 0, "The bytes sent or dropped should all be completed");
+  NS_TEST_EXPECT_MSG_EQ (m_device->GetTxQueue ()->IsStopped (), false, "The device should not stay stopped");
+  NS_TEST_EXPECT_MSG_GT (m_wakes, 0, "The upper layer should have been woken");
+
+  m_device->Dispose ();
+  m_device = 0;
+  Simulator::Destroy ();
+}
+
+class SimpleNetDeviceTestSuite : public TestSuite
+{
+public:
+  SimpleNetDeviceTestSuite ()
+    : TestSuite ("simple-net-device", UNIT)
+  {
+    AddTestCase (new SimpleNetDeviceQueueLimitsTestCase, TestCase::QUICK);
+  }
+} g_simpleNetDeviceTestSuite;
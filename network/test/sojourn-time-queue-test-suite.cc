@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/sojourn-time-queue.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+class SojournTimeQueueTestCase : public TestCase
+{
+public:
+  SojournTimeQueueTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Dequeue a packet and check it is the expected one
+   * \param expectedUid uid of the packet expected at the head of the queue
+   * \param expectedDrops expected number of sojourn drops after the dequeue
+   */
+  void CheckDequeue (uint64_t expectedUid, uint32_t expectedDrops);
+  Ptr<SojournTimeQueue> m_queue; //!< the queue under test
+};
+
+SojournTimeQueueTestCase::SojournTimeQueueTestCase ()
+  : TestCase ("Sanity check on the sojourn time queue implementation")
+{
+}
+
+void
+SojournTimeQueueTestCase::CheckDequeue (uint64_t expectedUid, uint32_t expectedDrops)
+{
+  Ptr<QueueItem> item = m_queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ ((item != 0), true, "There should be a packet to dequeue");
+  NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->GetUid (), expectedUid, "Unexpected packet at the head of the queue");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetDropSojourn (), expectedDrops, "Unexpected number of sojourn drops");
+}
+
+void
+SojournTimeQueueTestCase::DoRun (void)
+{
+  m_queue = CreateObject<SojournTimeQueue> ();
+  m_queue->SetAttribute ("FrameDuration", TimeValue (Seconds (1.0)));
+  m_queue->SetAttribute ("TargetFrames", DoubleValue (1.0));
+  m_queue->SetAttribute ("IntervalFrames", DoubleValue (2.0));
+
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetTarget (), Seconds (1.0), "Target should be one frame");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetInterval (), Seconds (2.0), "Interval should be two frames");
+
+  Ptr<Packet> p[5];
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      p[i] = Create<Packet> (100);
+      m_queue->Enqueue (Create<QueueItem> (p[i]));
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 5, "There should be five packets in there");
+
+  // below target
+  Simulator::Schedule (Seconds (0.5), &SojournTimeQueueTestCase::CheckDequeue, this, p[0]->GetUid (), 0);
+  // above target, but not for a whole interval yet
+  Simulator::Schedule (Seconds (1.5), &SojournTimeQueueTestCase::CheckDequeue, this, p[1]->GetUid (), 0);
+  // above target for an interval: the head is dropped and the next packet returned
+  Simulator::Schedule (Seconds (4.0), &SojournTimeQueueTestCase::CheckDequeue, this, p[3]->GetUid (), 1);
+  // a single packet left: no more than MinBytes behind the head, so the queue
+  // leaves the dropping state and returns the head without another drop
+  Simulator::Schedule (Seconds (4.5), &SojournTimeQueueTestCase::CheckDequeue, this, p[4]->GetUid (), 1);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 0, "There should be no packets in there");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetTotalDroppedPackets (), 1, "One packet should have been dropped");
+
+  Simulator::Destroy ();
+  m_queue = 0;
+}
+
+static class SojournTimeQueueTestSuite : public TestSuite
+{
+public:
+  SojournTimeQueueTestSuite ()
+    : TestSuite ("sojourn-time-queue", UNIT)
+  {
+    AddTestCase (new SojournTimeQueueTestCase (), TestCase::QUICK);
+  }
+} g_sojournTimeQueueTestSuite;
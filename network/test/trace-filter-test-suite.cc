@@ -0,0 +1,277 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/trace-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/lwsn-header.h"
+#include "ns3/trace-filter.h"
+
+using namespace ns3;
+
+/**
+ * \param osid the Osid of the header
+ * \param type the type of the header
+ * \param size the size of the payload
+ * \returns a packet starting with an LwsnHeader
+ */
+static Ptr<Packet>
+CreateLwsnPacket (uint16_t osid, LwsnHeader::LwsnType type, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  LwsnHeader header;
+  header.SetOsid (osid);
+  header.SetType (type);
+  p->AddHeader (header);
+  return p;
+}
+
+class TraceFilterPredicateTestCase : public TestCase
+{
+public:
+  TraceFilterPredicateTestCase ();
+  virtual void DoRun (void);
+};
+
+TraceFilterPredicateTestCase::TraceFilterPredicateTestCase ()
+  : TestCase ("Check the predicates of a trace filter")
+{
+}
+
+void
+TraceFilterPredicateTestCase::DoRun (void)
+{
+  Ptr<TraceFilter> all = Create<TraceFilter> ();
+  NS_TEST_EXPECT_MSG_EQ (all->Pass (Create<Packet> (1)), true, "Nothing is filtered by default");
+
+  Ptr<TraceFilter> size = Create<TraceFilter> ();
+  size->SetSizeRange (30, 50);
+  NS_TEST_EXPECT_MSG_EQ (size->Pass (Create<Packet> (29)), false, "Packet smaller than the range");
+  NS_TEST_EXPECT_MSG_EQ (size->Pass (Create<Packet> (30)), true, "Packet at the bottom of the range");
+  NS_TEST_EXPECT_MSG_EQ (size->Pass (Create<Packet> (50)), true, "Packet at the top of the range");
+  NS_TEST_EXPECT_MSG_EQ (size->Pass (Create<Packet> (51)), false, "Packet larger than the range");
+  NS_TEST_EXPECT_MSG_EQ (size->GetNPassed (), 2, "Unexpected number of packets passed");
+  NS_TEST_EXPECT_MSG_EQ (size->GetNFiltered (), 2, "Unexpected number of packets filtered");
+
+  Ptr<TraceFilter> type = Create<TraceFilter> ();
+  type->SetLwsnType (LwsnHeader::FORWARDING);
+  NS_TEST_EXPECT_MSG_EQ (type->Pass (CreateLwsnPacket (1, LwsnHeader::FORWARDING, 10)), true,
+                         "Packet of the type traced");
+  NS_TEST_EXPECT_MSG_EQ (type->Pass (CreateLwsnPacket (1, LwsnHeader::IACK, 10)), false,
+                         "Packet of another type");
+  NS_TEST_EXPECT_MSG_EQ (type->Pass (Create<Packet> (4)), false, "Packet too short for a header");
+
+  Ptr<SimpleNetDevice> traced = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> other = CreateObject<SimpleNetDevice> ();
+  Ptr<TraceFilter> device = Create<TraceFilter> ();
+  NS_TEST_EXPECT_MSG_EQ (device->AcceptsDevice (other), true, "Every device is traced by default");
+  device->AddDevice (traced);
+  NS_TEST_EXPECT_MSG_EQ (device->AcceptsDevice (traced), true, "Device added");
+  NS_TEST_EXPECT_MSG_EQ (device->AcceptsDevice (other), false, "Device not added");
+}
+
+class TraceFilterSamplingTestCase : public TestCase
+{
+public:
+  TraceFilterSamplingTestCase ();
+  virtual void DoRun (void);
+};
+
+TraceFilterSamplingTestCase::TraceFilterSamplingTestCase ()
+  : TestCase ("Check the sampling of a trace filter")
+{
+}
+
+void
+TraceFilterSamplingTestCase::DoRun (void)
+{
+  Ptr<TraceFilter> sampling = Create<TraceFilter> ();
+  sampling->SetSampling (3);
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sampling->Pass (Create<Packet> (10)), i % 3 == 0,
+                             "Packet " << i << " not sampled as expected");
+    }
+
+  Ptr<TraceFilter> flow = Create<TraceFilter> ();
+  flow->SetMaxPacketsPerFlow (2);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (flow->Pass (CreateLwsnPacket (1, LwsnHeader::ORIGINAL_TRANSMISSION, 10)), i < 2,
+                             "Packet " << i << " of the first flow");
+      NS_TEST_EXPECT_MSG_EQ (flow->Pass (CreateLwsnPacket (2, LwsnHeader::ORIGINAL_TRANSMISSION, 10)), i < 2,
+                             "Packet " << i << " of the second flow");
+    }
+
+  // the sampling only counts the packets satisfying the predicates
+  Ptr<TraceFilter> both = Create<TraceFilter> ();
+  both->SetSizeRange (0, 10);
+  both->SetSampling (2);
+  NS_TEST_EXPECT_MSG_EQ (both->Pass (Create<Packet> (10)), true, "First packet matched");
+  NS_TEST_EXPECT_MSG_EQ (both->Pass (Create<Packet> (100)), false, "Packet not matched");
+  NS_TEST_EXPECT_MSG_EQ (both->Pass (Create<Packet> (10)), false, "Second packet matched");
+  NS_TEST_EXPECT_MSG_EQ (both->Pass (Create<Packet> (10)), true, "Third packet matched");
+}
+
+class TraceFilterWindowTestCase : public TestCase
+{
+public:
+  TraceFilterWindowTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Pass a packet to the filter and record the result
+   */
+  void Trace (void);
+  Ptr<TraceFilter> m_filter; //!< the filter
+  std::vector<bool> m_passed; //!< the results of the filter
+};
+
+TraceFilterWindowTestCase::TraceFilterWindowTestCase ()
+  : TestCase ("Check the time windows of a trace filter")
+{
+}
+
+void
+TraceFilterWindowTestCase::Trace (void)
+{
+  m_passed.push_back (m_filter->Pass (Create<Packet> (10)));
+}
+
+void
+TraceFilterWindowTestCase::DoRun (void)
+{
+  m_filter = Create<TraceFilter> ();
+  m_filter->AddTimeWindow (Seconds (2), Seconds (4));
+  m_filter->AddTimeWindow (Seconds (6), Seconds (7));
+  for (uint32_t i = 1; i <= 7; i++)
+    {
+      Simulator::Schedule (Seconds (i), &TraceFilterWindowTestCase::Trace, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  const bool expected[] = { false, true, true, false, false, true, false };
+  NS_TEST_ASSERT_MSG_EQ (m_passed.size (), 7, "Every packet should be filtered");
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_passed[i], expected[i], "Unexpected result at " << i + 1 << "s");
+    }
+}
+
+class TraceFilterHookTestCase : public TestCase
+{
+public:
+  TraceFilterHookTestCase ();
+  virtual void DoRun (void);
+};
+
+TraceFilterHookTestCase::TraceFilterHookTestCase ()
+  : TestCase ("Check the packets written by a filtered default sink")
+{
+}
+
+/**
+ * \param device a device
+ * \param size the size of the packet
+ *
+ * The device drops every packet it receives, and traces it on PhyRxDrop.
+ */
+static void
+DropPacket (Ptr<SimpleNetDevice> device, uint32_t size)
+{
+  device->Receive (Create<Packet> (size), 0, Mac48Address::ConvertFrom (device->GetAddress ()),
+                   Mac48Address::GetBroadcast ());
+}
+
+/**
+ * \param os a stream
+ * \returns the number of lines written to the stream
+ */
+static uint32_t
+CountLines (const std::ostringstream &os)
+{
+  std::string s = os.str ();
+  return std::count (s.begin (), s.end (), '\n');
+}
+
+void
+TraceFilterHookTestCase::DoRun (void)
+{
+  std::ostringstream os;
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (&os);
+  Ptr<SimpleNetDevice> traced = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> other = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> devices[] = { traced, other };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (1));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      devices[i]->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+
+  AsciiTraceHelper ascii;
+  Ptr<TraceFilter> filter = Create<TraceFilter> ();
+  filter->AddDevice (traced);
+  filter->SetSizeRange (0, 100);
+  ascii.HookDefaultDropSinkWithoutContext (traced, "PhyRxDrop", stream, filter);
+  ascii.HookDefaultDropSinkWithoutContext (other, "PhyRxDrop", stream, filter);
+
+  DropPacket (traced, 50);
+  DropPacket (traced, 200);
+  DropPacket (other, 50);
+  NS_TEST_EXPECT_MSG_EQ (CountLines (os), 1, "Only the small packet of the traced device is written");
+  NS_TEST_EXPECT_MSG_EQ (filter->GetNPassed (), 1, "Unexpected number of packets passed");
+  NS_TEST_EXPECT_MSG_EQ (filter->GetNFiltered (), 1, "The other device should not be hooked");
+
+  // the default filter applies to the hooks given no filter
+  Ptr<TraceFilter> defaultFilter = Create<TraceFilter> ();
+  defaultFilter->AddDevice (traced);
+  AsciiTraceHelper::SetDefaultFilter (defaultFilter);
+  ascii.HookDefaultDropSinkWithoutContext (other, "PhyRxDrop", stream);
+  DropPacket (other, 50);
+  NS_TEST_EXPECT_MSG_EQ (CountLines (os), 1, "The other device should not be hooked by default");
+
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ ((AsciiTraceHelper::GetDefaultFilter () == 0), true, "Default filter not reset");
+}
+
+class TraceFilterTestSuite : public TestSuite
+{
+public:
+  TraceFilterTestSuite ()
+    : TestSuite ("trace-filter", UNIT)
+  {
+    AddTestCase (new TraceFilterPredicateTestCase, TestCase::QUICK);
+    AddTestCase (new TraceFilterSamplingTestCase, TestCase::QUICK);
+    AddTestCase (new TraceFilterWindowTestCase, TestCase::QUICK);
+    AddTestCase (new TraceFilterHookTestCase, TestCase::QUICK);
+  }
+} g_traceFilterTestSuite;
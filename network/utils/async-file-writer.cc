@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "async-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncFileWriter");
+
+/**
+ * \brief A stream buffer waiting for an AsyncFileWriter when synchronized
+ *
+ * The buffer has no room: it only drains the writer when its stream is
+ * flushed.
+ */
+class AsyncFileWriterDrainBuffer : public std::streambuf
+{
+public:
+  /**
+   * \param writer the writer to drain
+   */
+  AsyncFileWriterDrainBuffer (AsyncFileWriter *writer)
+    : m_writer (writer)
+  {
+  }
+
+protected:
+  virtual int sync (void)
+  {
+    m_writer->Flush ();
+    return 0;
+  }
+
+private:
+  AsyncFileWriter *m_writer; //!< the writer to drain
+};
+
+AsyncFileWriter::AsyncFileWriter (std::ostream *os, uint32_t blockSize, uint32_t maxBlocks)
+  : m_os (os),
+    m_blockSize (blockSize),
+    m_busy (false),
+    m_stop (false),
+    m_fail (false),
+    m_stalls (0)
+{
+  NS_LOG_FUNCTION (this << os << blockSize << maxBlocks);
+  NS_ASSERT (blockSize > 0);
+  NS_ASSERT_MSG (maxBlocks >= 2, "The writer needs a block to fill and a block to write");
+  m_current.data = new uint8_t [blockSize];
+  m_current.used = 0;
+  for (uint32_t i = 1; i < maxBlocks; i++)
+    {
+      Block block;
+      block.data = new uint8_t [blockSize];
+      block.used = 0;
+      m_free.push_back (block);
+    }
+  m_drainBuffer = new AsyncFileWriterDrainBuffer (this);
+  m_drainStream = new std::ostream (m_drainBuffer);
+  m_thread = std::thread (&AsyncFileWriter::Run, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_cond.notify_all ();
+  m_thread.join ();
+  delete m_drainStream;
+  delete m_drainBuffer;
+  delete [] m_current.data;
+  for (std::vector<Block>::iterator i = m_free.begin (); i != m_free.end (); i++)
+    {
+      delete [] i->data;
+    }
+}
+
+uint8_t *
+AsyncFileWriter::Reserve (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (size <= m_blockSize);
+  if (m_current.used + size > m_blockSize)
+    {
+      Submit ();
+    }
+  uint8_t *record = m_current.data + m_current.used;
+  m_current.used += size;
+  return record;
+}
+
+void
+AsyncFileWriter::Write (const uint8_t *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+  while (size > 0)
+    {
+      if (m_current.used == m_blockSize)
+        {
+          Submit ();
+        }
+      uint32_t n = std::min (size, m_blockSize - m_current.used);
+      memcpy (m_current.data + m_current.used, data, n);
+      m_current.used += n;
+      data += n;
+      size -= n;
+    }
+}
+
+void
+AsyncFileWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current.used > 0)
+    {
+      Submit ();
+    }
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (!m_full.empty () || m_busy)
+    {
+      m_cond.wait (lock);
+    }
+  // the writer thread is idle: the stream is ours
+  m_os->flush ();
+  m_fail = m_fail || m_os->fail ();
+}
+
+std::ostream *
+AsyncFileWriter::GetDrainStream (void)
+{
+  return m_drainStream;
+}
+
+uint32_t
+AsyncFileWriter::GetBlockSize (void) const
+{
+  return m_blockSize;
+}
+
+bool
+AsyncFileWriter::Fail (void) const
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  return m_fail;
+}
+
+uint64_t
+AsyncFileWriter::GetStalls (void) const
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  return m_stalls;
+}
+
+void
+AsyncFileWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_full.push_back (m_current);
+  m_cond.notify_all ();
+  if (m_free.empty ())
+    {
+      // back-pressure: wait for the writer thread to release a block
+      m_stalls++;
+      while (m_free.empty ())
+        {
+          m_cond.wait (lock);
+        }
+    }
+  m_current = m_free.back ();
+  m_free.pop_back ();
+}
+
+void
+AsyncFileWriter::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (m_full.empty () && !m_stop)
+        {
+          m_cond.wait (lock);
+        }
+      if (m_full.empty ())
+        {
+          // stopped, and every block has been written
+          return;
+        }
+      Block block = m_full.front ();
+      m_full.pop_front ();
+      m_busy = true;
+      lock.unlock ();
+      m_os->write (reinterpret_cast<const char *> (block.data), block.used);
+      bool fail = m_os->fail ();
+      lock.lock ();
+      block.used = 0;
+      m_free.push_back (block);
+      m_busy = false;
+      m_fail = m_fail || fail;
+      m_cond.notify_all ();
+    }
+}
+
+} // namespace ns3
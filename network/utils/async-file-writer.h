@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <stdint.h>
+#include <ostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Write a stream of records to an output stream from a
+ * background thread.
+ *
+ * The records are copied into blocks of a fixed size. A full block is
+ * handed to a writer thread, which writes it to the stream with a single
+ * call, while the caller goes on filling the next block. At most
+ * a fixed number of blocks exist: when all of them wait for the writer
+ * thread, the caller blocks until one of them has been written, so
+ * that the memory used stays bounded when the stream is slower than
+ * the simulation.
+ *
+ * The stream must not be used by anybody else while the writer exists,
+ * except after a call to Flush, which returns once the writer thread
+ * has written every block and is idle.
+ */
+class AsyncFileWriter
+{
+public:
+  /**
+   * \brief Start the writer thread.
+   *
+   * \param os the stream to write to
+   * \param blockSize the size of the blocks, in bytes
+   * \param maxBlocks the number of blocks, including the one being filled;
+   *        at least 2
+   */
+  AsyncFileWriter (std::ostream *os, uint32_t blockSize, uint32_t maxBlocks);
+  /**
+   * Write the pending blocks and stop the writer thread.
+   */
+  ~AsyncFileWriter ();
+
+  /**
+   * \brief Reserve room for a record in the current block.
+   *
+   * The returned memory must be filled before the next call to
+   * a method of this writer.
+   *
+   * \param size the record size, at most the block size
+   * \returns the memory of the record
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \brief Copy bytes into the blocks.
+   *
+   * \param data the bytes to copy
+   * \param size the number of bytes
+   */
+  void Write (const uint8_t *data, uint32_t size);
+  /**
+   * \brief Write all the bytes copied so far to the stream and flush it.
+   *
+   * Blocks until the writer thread is idle.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Get a stream which drains this writer when flushed.
+   *
+   * Flushing the returned stream calls Flush; nothing can be written to
+   * it. The stream the writer owns must not be registered with FatalImpl,
+   * which would flush it from the main thread: this stream is registered
+   * instead, so that nothing written is lost on a fatal error.
+   *
+   * \returns the stream, valid as long as this writer
+   */
+  std::ostream *GetDrainStream (void);
+
+  /**
+   * \returns the block size
+   */
+  uint32_t GetBlockSize (void) const;
+  /**
+   * \returns true if writing a block to the stream has failed
+   */
+  bool Fail (void) const;
+  /**
+   * \returns the number of times the caller had to wait for a free block
+   */
+  uint64_t GetStalls (void) const;
+
+private:
+  /**
+   * \brief A block of records
+   */
+  struct Block
+  {
+    uint8_t *data; //!< the block memory
+    uint32_t used; //!< the number of bytes filled
+  };
+
+  /**
+   * \brief Hand the current block to the writer thread and take a free one.
+   */
+  void Submit (void);
+  /**
+   * \brief The writer thread: write the full blocks until stopped.
+   */
+  void Run (void);
+
+  std::ostream *m_os;          //!< the stream to write to
+  uint32_t m_blockSize;        //!< the size of the blocks
+  Block m_current;             //!< the block being filled by the caller
+  std::vector<Block> m_free;   //!< the blocks ready to be filled
+  std::deque<Block> m_full;    //!< the blocks waiting for the writer thread
+  bool m_busy;                 //!< true while the writer thread writes a block
+  bool m_stop;                 //!< true when the writer thread must exit
+  bool m_fail;                 //!< true once a block write has failed
+  uint64_t m_stalls;           //!< number of waits for a free block
+  mutable std::mutex m_mutex;  //!< protects the block lists and flags
+  std::condition_variable m_cond; //!< signals block list changes
+  std::thread m_thread;        //!< the writer thread
+  std::streambuf *m_drainBuffer; //!< the buffer calling Flush when synchronized
+  std::ostream *m_drainStream; //!< the stream returned by GetDrainStream
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_WRITER_H */
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/buffer.h"
+#include "ns3/lwsn-header.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+const uint32_t MAGIC = 0x4e425452;      /**< Magic number identifying a binary trace */
+const uint16_t VERSION = 1;             /**< Version of the binary trace format */
+const uint32_t HEADER_SIZE = 6;         /**< Size of the header of a binary trace */
+const uint32_t RECORD_SIZE = 31;        /**< Size of a record, without the packet bytes */
+
+const uint32_t BinaryTraceFile::NO_ID;
+const uint32_t BinaryTraceFile::MAX_SNAPLEN;
+
+/**
+ * \param buffer the buffer to write to
+ * \param val the value to write
+ * \param size the number of bytes of the value
+ * \returns the position after the value
+ */
+static uint8_t *
+WriteLe (uint8_t *buffer, uint64_t val, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      *buffer++ = (val >> (8 * i)) & 0xff;
+    }
+  return buffer;
+}
+
+/**
+ * \param buffer the buffer to read from
+ * \param size the number of bytes of the value
+ * \returns the value read
+ */
+static uint64_t
+ReadLe (const uint8_t *buffer, uint32_t size)
+{
+  uint64_t val = 0;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      val |= static_cast<uint64_t> (buffer[i]) << (8 * i);
+    }
+  return val;
+}
+
+void
+BinaryTraceFile::WriteHeader (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  uint8_t header[HEADER_SIZE];
+  WriteLe (WriteLe (header, MAGIC, 4), VERSION, 2);
+  os.write (reinterpret_cast<const char *> (header), HEADER_SIZE);
+}
+
+void
+BinaryTraceFile::Write (std::ostream &os, Time t, Source const &source, Ptr<const Packet> p, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (&os << t << p << snapLen);
+  uint8_t record[RECORD_SIZE + MAX_SNAPLEN];
+  uint32_t captured = p->CopyData (record + RECORD_SIZE, std::min (snapLen, MAX_SNAPLEN));
+
+  uint8_t *start = record;
+  start = WriteLe (start, t.GetNanoSeconds (), 8);
+  start = WriteLe (start, source.m_event, 1);
+  start = WriteLe (start, source.m_node, 4);
+  start = WriteLe (start, source.m_device, 4);
+  start = WriteLe (start, p->GetUid (), 8);
+  start = WriteLe (start, p->GetSize (), 4);
+  start = WriteLe (start, captured, 2);
+  NS_ASSERT (start == record + RECORD_SIZE);
+  os.write (reinterpret_cast<const char *> (record), RECORD_SIZE + captured);
+}
+
+bool
+BinaryTraceFile::Format (std::istream &is, std::ostream &os)
+{
+  NS_LOG_FUNCTION (&is << &os);
+  uint8_t header[HEADER_SIZE];
+  is.read (reinterpret_cast<char *> (header), HEADER_SIZE);
+  if (is.gcount () != HEADER_SIZE || ReadLe (header, 4) != MAGIC || ReadLe (header + 4, 2) != VERSION)
+    {
+      return false;
+    }
+
+  uint8_t record[RECORD_SIZE];
+  uint8_t data[0x10000];
+  while (is.read (reinterpret_cast<char *> (record), RECORD_SIZE))
+    {
+      int64_t ns = ReadLe (record, 8);
+      uint8_t event = record[8];
+      uint32_t node = ReadLe (record + 9, 4);
+      uint32_t device = ReadLe (record + 13, 4);
+      uint64_t uid = ReadLe (record + 17, 8);
+      uint32_t size = ReadLe (record + 25, 4);
+      uint16_t captured = ReadLe (record + 29, 2);
+      is.read (reinterpret_cast<char *> (data), captured);
+      if (is.gcount () != captured)
+        {
+          return false;
+        }
+
+      os << event << " " << ns / 1e9 << " ";
+      if (node != NO_ID)
+        {
+          os << "/NodeList/" << node;
+          if (device != NO_ID)
+            {
+              os << "/DeviceList/" << device;
+            }
+          os << " ";
+        }
+      LwsnHeader header;
+      if (captured >= header.GetSerializedSize ())
+        {
+          // printed as Packet::Print prints the packets of the ascii traces
+          Buffer buffer;
+          buffer.AddAtStart (captured);
+          buffer.Begin ().Write (data, captured);
+          header.Deserialize (buffer.Begin ());
+          os << LwsnHeader::GetTypeId ().GetName () << " (";
+          header.Print (os);
+          os << ")";
+          if (size > header.GetSerializedSize ())
+            {
+              os << " Payload (size=" << size - header.GetSerializedSize () << ")";
+            }
+          os << "\n";
+          continue;
+        }
+      os << "ns3::Packet uid=" << uid << " size=" << size;
+      if (captured != 0)
+        {
+          os << " [" << std::hex << std::setfill ('0');
+          for (uint16_t i = 0; i < captured; ++i)
+            {
+              os << (i == 0 ? "" : " ") << std::setw (2) << static_cast<uint32_t> (data[i]);
+            }
+          os << std::dec << std::setfill (' ') << "]";
+        }
+      os << "\n";
+    }
+  // a record cut short by the end of the trace
+  return is.gcount () == 0;
+}
+
+} // namespace ns3
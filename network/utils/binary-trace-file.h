@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <ostream>
+#include <istream>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \brief Binary records of the ascii trace events
+ *
+ * Writing an ascii trace formats the time, the context and the whole
+ * packet for every event.  A binary trace instead stores, for every
+ * event, a fixed size record holding the time, the kind of event, the
+ * ids of the node and of the device, the uid and the size of the
+ * packet, followed by the first bytes of the packet.  No text is
+ * produced while the simulation runs: Format turns the records into
+ * ascii trace lines afterwards, e.g. with the ascii-trace-format
+ * program.
+ *
+ * The fields are stored in little endian order, whatever the host, so
+ * that a trace can be formatted on another machine.
+ */
+class BinaryTraceFile
+{
+public:
+  /**
+   * The kinds of events, named after the ascii trace operations
+   */
+  enum Event
+  {
+    ENQUEUE = '+',
+    DEQUEUE = '-',
+    DROP = 'd',
+    RECEIVE = 'r'
+  };
+
+  /**
+   * \brief The source of the events of a trace sink
+   */
+  struct Source
+  {
+    uint8_t m_event;   //!< the kind of event, an Event
+    uint32_t m_node;   //!< the node id, NO_ID if unknown
+    uint32_t m_device; //!< the device index, NO_ID if unknown
+  };
+
+  static const uint32_t NO_ID = 0xffffffff;   //!< an unknown node or device
+  static const uint32_t MAX_SNAPLEN = 256;    //!< the maximum number of packet bytes per record
+
+  /**
+   * \brief Write the header of a binary trace.
+   *
+   * \param os the binary trace
+   */
+  static void WriteHeader (std::ostream &os);
+
+  /**
+   * \brief Write the record of an event.
+   *
+   * \param os the binary trace
+   * \param t the time of the event
+   * \param source the source of the event
+   * \param p the packet
+   * \param snapLen the number of packet bytes to keep, at most MAX_SNAPLEN
+   */
+  static void Write (std::ostream &os, Time t, Source const &source, Ptr<const Packet> p, uint32_t snapLen);
+
+  /**
+   * \brief Write the ascii trace lines of a binary trace.
+   *
+   * Every record becomes a line holding the event, the time in
+   * seconds and the node and device path when known. When the bytes
+   * kept hold an LwsnHeader, it is decoded and followed by the size of
+   * the payload, as in the ascii traces. Otherwise, the line ends with
+   * the uid and the size of the packet and the bytes kept, in
+   * hexadecimal.
+   *
+   * \param is the binary trace
+   * \param os the ascii trace
+   * \returns false if is is not a binary trace or ends with a
+   *          truncated record
+   */
+  static bool Format (std::istream &is, std::ostream &os);
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
@@ -26,6 +26,13 @@
  * code or tables extracted from it, as desired without restriction.
  */
 #include <stdint.h>
+#include "crc32.h"
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define CRC32_CLMUL 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 namespace ns3 {
 
@@ -67,17 +74,217 @@ static uint32_t crc32table[256] = {
 0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D 
 };
 
-uint32_t
-CRC32Calculate (const uint8_t *data, int length)
+/**
+ * Tables of CRC-32 values for slicing-by-8: entry k of table n is the
+ * CRC-32 of byte k followed by n zero bytes.
+ */
+static struct CRC32Slices
 {
-  uint32_t crc = 0xffffffff;
+  CRC32Slices ()
+  {
+    for (uint32_t i = 0; i < 256; i++)
+      {
+        table[0][i] = crc32table[i];
+      }
+    for (uint32_t n = 1; n < 8; n++)
+      {
+        for (uint32_t i = 0; i < 256; i++)
+          {
+            uint32_t prev = table[n - 1][i];
+            table[n][i] = (prev >> 8) ^ crc32table[prev & 0xff];
+          }
+      }
+  }
+  uint32_t table[8][256]; //!< the tables
+} g_crc32Slices; //!< Tables of CRC-32 values for slicing-by-8
 
+/**
+ * Update the CRC-32 register with the slicing-by-8 algorithm
+ *
+ * \param crc the CRC-32 register, i.e., the complement of the crc-32
+ * \param data buffer to calculate the checksum for
+ * \param length the length of the buffer (bytes)
+ * \returns the updated register
+ */
+static uint32_t
+CRC32UpdateSlices (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  const uint32_t (*t)[256] = g_crc32Slices.table;
+  while (length >= 8)
+    {
+      uint32_t one = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+      uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+      crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^
+        t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+        t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^
+        t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+      data += 8;
+      length -= 8;
+    }
   while (length--)
     {
       crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
     }
-  return ~crc;
+  return crc;
 }
 
-} // namespace ns3
+#ifdef CRC32_CLMUL
+/**
+ * Update the CRC-32 register by folding 16-byte blocks with carry-less
+ * multiplications (PCLMULQDQ), as described in "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction", Intel, 2009.
+ *
+ * \param crc the CRC-32 register, i.e., the complement of the crc-32
+ * \param data buffer to calculate the checksum for
+ * \param length the length of the buffer (bytes), at least 64 and
+ *        a multiple of 16
+ * \returns the updated register
+ */
+__attribute__ ((target ("pclmul,sse4.1")))
+static uint32_t
+CRC32UpdateClmul (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  // x^(4*128+32) mod P, x^(4*128-32) mod P, and so on, bit-reflected
+  const __m128i k1k2 = _mm_set_epi64x (0x01c6e41596LL, 0x0154442bd4LL);
+  const __m128i k3k4 = _mm_set_epi64x (0x00ccaa009eLL, 0x01751997d0LL);
+  const __m128i k5k0 = _mm_set_epi64x (0, 0x0163cd6124LL);
+  const __m128i poly = _mm_set_epi64x (0x01f7011641LL, 0x01db710641LL);
+  const __m128i mask = _mm_setr_epi32 (~0, 0, ~0, 0);
 
+  __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x00));
+  x2 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x10));
+  x3 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x20));
+  x4 = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x30));
+  x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 (crc));
+  data += 64;
+  length -= 64;
+
+  // fold four blocks at a time
+  while (length >= 64)
+    {
+      x5 = _mm_clmulepi64_si128 (x1, k1k2, 0x00);
+      x6 = _mm_clmulepi64_si128 (x2, k1k2, 0x00);
+      x7 = _mm_clmulepi64_si128 (x3, k1k2, 0x00);
+      x8 = _mm_clmulepi64_si128 (x4, k1k2, 0x00);
+      x1 = _mm_clmulepi64_si128 (x1, k1k2, 0x11);
+      x2 = _mm_clmulepi64_si128 (x2, k1k2, 0x11);
+      x3 = _mm_clmulepi64_si128 (x3, k1k2, 0x11);
+      x4 = _mm_clmulepi64_si128 (x4, k1k2, 0x11);
+      x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5), _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x00)));
+      x2 = _mm_xor_si128 (_mm_xor_si128 (x2, x6), _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x10)));
+      x3 = _mm_xor_si128 (_mm_xor_si128 (x3, x7), _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x20)));
+      x4 = _mm_xor_si128 (_mm_xor_si128 (x4, x8), _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 0x30)));
+      data += 64;
+      length -= 64;
+    }
+
+  // fold the four blocks into one
+  x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+  x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x3), x5);
+  x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+  x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x4), x5);
+
+  // fold the remaining blocks one at a time
+  while (length >= 16)
+    {
+      x5 = _mm_clmulepi64_si128 (x1, k3k4, 0x00);
+      x1 = _mm_clmulepi64_si128 (x1, k3k4, 0x11);
+      x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5), _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data)));
+      data += 16;
+      length -= 16;
+    }
+
+  // fold 128 bits to 64 bits
+  x2 = _mm_clmulepi64_si128 (x1, k3k4, 0x10);
+  x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 8), x2);
+  x2 = _mm_srli_si128 (x1, 4);
+  x1 = _mm_and_si128 (x1, mask);
+  x1 = _mm_clmulepi64_si128 (x1, k5k0, 0x00);
+  x1 = _mm_xor_si128 (x1, x2);
+
+  // Barrett reduction to 32 bits
+  x2 = _mm_and_si128 (x1, mask);
+  x2 = _mm_clmulepi64_si128 (x2, poly, 0x10);
+  x2 = _mm_and_si128 (x2, mask);
+  x2 = _mm_clmulepi64_si128 (x2, poly, 0x00);
+  x1 = _mm_xor_si128 (x1, x2);
+  return _mm_extract_epi32 (x1, 1);
+}
+
+/**
+ * \returns true if the CPU supports PCLMULQDQ and SSE4.1
+ */
+static bool
+CRC32HasClmul (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx))
+    {
+      return false;
+    }
+  return (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+}
+
+/// Whether CRC32UpdateClmul may be used on this CPU
+static const bool g_crc32Clmul = CRC32HasClmul ();
+#endif /* CRC32_CLMUL */
+
+uint32_t
+CRC32Update (uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  crc = ~crc;
+#ifdef CRC32_CLMUL
+  if (g_crc32Clmul && length >= 64)
+    {
+      uint32_t blocks = length & ~15U;
+      crc = CRC32UpdateClmul (crc, data, blocks);
+      data += blocks;
+      length -= blocks;
+    }
+#endif /* CRC32_CLMUL */
+  return ~CRC32UpdateSlices (crc, data, length);
+}
+
+uint32_t
+CRC32Calculate (const uint8_t *data, int length)
+{
+  return CRC32Update (0, data, length);
+}
+
+CRC32StreamBuf::CRC32StreamBuf ()
+  : m_crc (0)
+{
+}
+
+uint32_t
+CRC32StreamBuf::GetCrc (void) const
+{
+  return m_crc;
+}
+
+std::streamsize
+CRC32StreamBuf::xsputn (const char *s, std::streamsize n)
+{
+  m_crc = CRC32Update (m_crc, reinterpret_cast<const uint8_t *> (s), n);
+  return n;
+}
+
+CRC32StreamBuf::int_type
+CRC32StreamBuf::overflow (int_type c)
+{
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      uint8_t byte = traits_type::to_char_type (c);
+      m_crc = CRC32Update (m_crc, &byte, 1);
+    }
+  return traits_type::not_eof (c);
+}
+
+} // namespace ns3
@@ -20,6 +20,7 @@
 #ifndef CRC32_H
 #define CRC32_H
 #include <stdint.h>
+#include <streambuf>
 
 namespace ns3 {
 
@@ -33,6 +34,50 @@ namespace ns3 {
  */
 uint32_t CRC32Calculate (const uint8_t *data, int length);
 
+/**
+ * Updates a CRC-32 with more input
+ *
+ * The CRC-32 of data split in several chunks is computed by calling
+ * this function on each chunk in turn, starting with a crc of zero:
+ * CRC32Update (CRC32Update (0, a, lengthA), b, lengthB) is the CRC-32
+ * of the concatenation of a and b.
+ *
+ * \param crc the crc-32 of the previous chunks, or zero
+ * \param data buffer holding the next chunk
+ * \param length the length of the buffer (bytes)
+ * \returns the crc-32 of the chunks so far.
+ */
+uint32_t CRC32Update (uint32_t crc, const uint8_t *data, uint32_t length);
+
+/**
+ * \brief A stream buffer which computes the CRC-32 of the data written to it
+ *
+ * This allows to compute the CRC-32 of a packet without copying it to a
+ * flat array first: Packet::CopyData (std::ostream *, uint32_t) writes
+ * each contiguous segment of the packet in turn.
+ *
+ * \code
+ *   CRC32StreamBuf crc;
+ *   std::ostream os (&crc);
+ *   p->CopyData (&os, p->GetSize ());
+ *   uint32_t fcs = crc.GetCrc ();
+ * \endcode
+ */
+class CRC32StreamBuf : public std::streambuf
+{
+public:
+  CRC32StreamBuf ();
+  /**
+   * \returns the crc-32 of the data written so far.
+   */
+  uint32_t GetCrc (void) const;
+protected:
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  virtual int_type overflow (int_type c);
+private:
+  uint32_t m_crc; //!< the crc-32 of the data written so far
+};
+
 } // namespace ns3
 
 #endif
@@ -23,6 +23,7 @@
 #include "ns3/trailer.h"
 #include "ethernet-trailer.h"
 #include "crc32.h"
+#include <ostream>
 
 namespace ns3 {
 
@@ -48,38 +49,30 @@ bool
 EthernetTrailer::CheckFcs (Ptr<const Packet> p) const
 {
   NS_LOG_FUNCTION (this << p);
-  int len = p->GetSize ();
-  uint8_t *buffer;
-  uint32_t crc;
-
   if (!m_calcFcs)
     {
       return true;
     }
 
-  buffer = new uint8_t[len];
-  p->CopyData (buffer, len);
-  crc = CRC32Calculate (buffer, len);
-  delete[] buffer;
-  return (m_fcs == crc);
+  CRC32StreamBuf crc;
+  std::ostream os (&crc);
+  p->CopyData (&os, p->GetSize ());
+  return (m_fcs == crc.GetCrc ());
 }
 
 void
 EthernetTrailer::CalcFcs (Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
-  int len = p->GetSize ();
-  uint8_t *buffer;
-
   if (!m_calcFcs)
     {
       return;
     }
 
-  buffer = new uint8_t[len];
-  p->CopyData (buffer, len);
-  m_fcs = CRC32Calculate (buffer, len);
-  delete[] buffer;
+  CRC32StreamBuf crc;
+  std::ostream os (&crc);
+  p->CopyData (&os, p->GetSize ());
+  m_fcs = crc.GetCrc ();
 }
 
 void
@@ -19,6 +19,7 @@
  */
 #include "flow-id-tag.h"
 #include "ns3/log.h"
+#include "ns3/thread-local.h"
 
 namespace ns3 {
 
@@ -95,7 +96,7 @@ uint32_t
 FlowIdTag::AllocateFlowId (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint32_t nextFlowId = 1;
+  static NS_THREAD_LOCAL uint32_t nextFlowId = 1;
   uint32_t flowId = nextFlowId;
   nextFlowId++;
   return flowId;
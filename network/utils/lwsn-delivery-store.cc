@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "lwsn-delivery-store.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LwsnDeliveryStore");
+
+const uint32_t MAGIC = 0x4c574453;      /**< Magic number identifying a delivery file */
+const uint16_t VERSION = 1;             /**< Version of the delivery file format */
+const uint16_t COLUMNS = 6;             /**< Number of columns of a delivery file */
+const uint32_t FILE_HEADER_SIZE = 16;   /**< Size of the file header */
+const uint32_t CHUNK_HEADER_SIZE = 8;   /**< Size of a chunk header */
+
+/**
+ * \param size a column size, in bytes
+ * \returns the size padded to a multiple of 8 bytes
+ */
+static uint64_t
+Pad (uint64_t size)
+{
+  return (size + 7) & ~static_cast<uint64_t> (7);
+}
+
+/**
+ * \param os the stream to write to
+ * \param column the column to write
+ */
+template <typename T>
+static void
+WriteColumn (std::ostream &os, std::vector<T> const &column)
+{
+  static const char padding[8] = { 0 };
+  uint64_t size = column.size () * sizeof (T);
+  os.write (reinterpret_cast<const char *> (&column[0]), size);
+  os.write (padding, Pad (size) - size);
+}
+
+LwsnDeliveryWriter::LwsnDeliveryWriter ()
+  : m_chunkSize (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LwsnDeliveryWriter::~LwsnDeliveryWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+LwsnDeliveryWriter::Open (std::string const &filename, uint32_t chunkSize)
+{
+  NS_LOG_FUNCTION (this << filename << chunkSize);
+  NS_ASSERT (chunkSize > 0);
+  Close ();
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    {
+      return false;
+    }
+  m_chunkSize = chunkSize;
+  m_nRecords = 0;
+  m_time.reserve (chunkSize);
+  m_delay.reserve (chunkSize);
+  m_osid.reserve (chunkSize);
+  m_did.reserve (chunkSize);
+  m_gateway.reserve (chunkSize);
+  m_hops.reserve (chunkSize);
+
+  uint8_t header[FILE_HEADER_SIZE];
+  memset (header, 0, FILE_HEADER_SIZE);
+  memcpy (header, &MAGIC, 4);
+  memcpy (header + 4, &VERSION, 2);
+  memcpy (header + 6, &COLUMNS, 2);
+  memcpy (header + 8, &chunkSize, 4);
+  m_file.write (reinterpret_cast<const char *> (header), FILE_HEADER_SIZE);
+
+  // the event keeps this writer alive until the simulation ends
+  Simulator::ScheduleDestroy (&LwsnDeliveryWriter::Close, Ptr<LwsnDeliveryWriter> (this));
+  return true;
+}
+
+void
+LwsnDeliveryWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  WriteChunk ();
+  m_file.close ();
+}
+
+void
+LwsnDeliveryWriter::Write (Time time, uint16_t osid, uint16_t did, uint16_t gateway, uint16_t hops, Time delay)
+{
+  NS_LOG_FUNCTION (this << time << osid << did << gateway << hops << delay);
+  NS_ASSERT_MSG (m_file.is_open (), "LwsnDeliveryWriter::Write(): file not open");
+  m_time.push_back (time.GetNanoSeconds ());
+  m_delay.push_back (delay.GetSeconds ());
+  m_osid.push_back (osid);
+  m_did.push_back (did);
+  m_gateway.push_back (gateway);
+  m_hops.push_back (hops);
+  m_nRecords++;
+  if (m_time.size () == m_chunkSize)
+    {
+      WriteChunk ();
+    }
+}
+
+uint64_t
+LwsnDeliveryWriter::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+void
+LwsnDeliveryWriter::WriteChunk (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_time.empty ())
+    {
+      return;
+    }
+  uint32_t header[CHUNK_HEADER_SIZE / 4] = { static_cast<uint32_t> (m_time.size ()), 0 };
+  m_file.write (reinterpret_cast<const char *> (header), CHUNK_HEADER_SIZE);
+  WriteColumn (m_file, m_time);
+  WriteColumn (m_file, m_delay);
+  WriteColumn (m_file, m_osid);
+  WriteColumn (m_file, m_did);
+  WriteColumn (m_file, m_gateway);
+  WriteColumn (m_file, m_hops);
+  m_time.clear ();
+  m_delay.clear ();
+  m_osid.clear ();
+  m_did.clear ();
+  m_gateway.clear ();
+  m_hops.clear ();
+}
+
+LwsnDeliveryReader::LwsnDeliveryReader ()
+  : m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+LwsnDeliveryReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  if (!m_file.Open (filename) || m_file.GetSize () < FILE_HEADER_SIZE)
+    {
+      Close ();
+      return false;
+    }
+  const uint8_t *data = m_file.GetData ();
+  uint32_t magic;
+  uint16_t version, columns;
+  memcpy (&magic, data, 4);
+  memcpy (&version, data + 4, 2);
+  memcpy (&columns, data + 6, 2);
+  if (magic != MAGIC || version != VERSION || columns != COLUMNS)
+    {
+      Close ();
+      return false;
+    }
+
+  uint64_t offset = FILE_HEADER_SIZE;
+  uint64_t size = m_file.GetSize ();
+  while (offset + CHUNK_HEADER_SIZE <= size)
+    {
+      uint32_t n;
+      memcpy (&n, data + offset, 4);
+      uint64_t wide = Pad (n * sizeof (int64_t));
+      uint64_t narrow = Pad (n * sizeof (uint16_t));
+      uint64_t next = offset + CHUNK_HEADER_SIZE + 2 * wide + 4 * narrow;
+      if (next > size)
+        {
+          NS_LOG_LOGIC ("Truncated chunk at offset " << offset);
+          break;
+        }
+      // the offsets are multiples of 8, and the mapping is page aligned
+      const uint8_t *column = data + offset + CHUNK_HEADER_SIZE;
+      Chunk chunk;
+      chunk.m_nRecords = n;
+      chunk.m_time = reinterpret_cast<const int64_t *> (column);
+      chunk.m_delay = reinterpret_cast<const double *> (column + wide);
+      chunk.m_osid = reinterpret_cast<const uint16_t *> (column + 2 * wide);
+      chunk.m_did = reinterpret_cast<const uint16_t *> (column + 2 * wide + narrow);
+      chunk.m_gateway = reinterpret_cast<const uint16_t *> (column + 2 * wide + 2 * narrow);
+      chunk.m_hops = reinterpret_cast<const uint16_t *> (column + 2 * wide + 3 * narrow);
+      m_chunks.push_back (chunk);
+      m_nRecords += n;
+      offset = next;
+    }
+  return true;
+}
+
+void
+LwsnDeliveryReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+  std::vector<Chunk> ().swap (m_chunks);
+  m_nRecords = 0;
+}
+
+uint64_t
+LwsnDeliveryReader::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+uint32_t
+LwsnDeliveryReader::GetNChunks (void) const
+{
+  return m_chunks.size ();
+}
+
+LwsnDeliveryReader::Chunk
+LwsnDeliveryReader::GetChunk (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT_MSG (index < m_chunks.size (), "No chunk " << index);
+  return m_chunks[index];
+}
+
+} // namespace ns3
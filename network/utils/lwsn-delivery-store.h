@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LWSN_DELIVERY_STORE_H
+#define LWSN_DELIVERY_STORE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "mapped-file.h"
+
+namespace ns3 {
+
+/**
+ * \brief Write the packets delivered to the LWSN gateways, column by column
+ *
+ * Every delivery is a record of six typed fields: the delivery time,
+ * the Osid and the Did of the packet, the gateway id, the number of
+ * hops and the delay since the packet was first sent, as recorded by
+ * the LwsnSendTimeTag of the packet.  The records are
+ * kept in memory and written in chunks: a chunk stores each field of
+ * its records as a contiguous array (a column block), so that a whole
+ * column is written with a single call, and can be used in place from
+ * a memory mapping of the file, e.g. with LwsnDeliveryReader or
+ * numpy.memmap.
+ *
+ * The file starts with a 16 byte header: the magic number 0x4c574453,
+ * the version (16 bits), the number of columns (16 bits), the number
+ * of records of a full chunk (32 bits), and 32 reserved bits.  Each
+ * chunk starts with an 8 byte header holding its number of records n,
+ * followed by the columns, each padded to a multiple of 8 bytes:
+ *  - time: n int64, nanoseconds
+ *  - delay: n float64, seconds
+ *  - osid, did, gateway, hops: n uint16 each
+ *
+ * The fields are in host byte order, which the magic number reveals.
+ */
+class LwsnDeliveryWriter : public SimpleRefCount<LwsnDeliveryWriter>
+{
+public:
+  LwsnDeliveryWriter ();
+  ~LwsnDeliveryWriter ();
+
+  /**
+   * \brief Create a file.
+   *
+   * The records written are flushed at Simulator::Destroy.
+   *
+   * \param filename the name of the file
+   * \param chunkSize the number of records of a chunk
+   * \returns false if the file cannot be created
+   */
+  bool Open (std::string const &filename, uint32_t chunkSize = 1 << 20);
+
+  /**
+   * \brief Write the records still in memory, and close the file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Record a delivery.
+   *
+   * \param time the delivery time
+   * \param osid the id of the sensor which sent the packet
+   * \param did the sequence number of the packet
+   * \param gateway the id of the gateway
+   * \param hops the number of transmissions of the packet
+   * \param delay the time since the packet was first sent
+   */
+  void Write (Time time, uint16_t osid, uint16_t did, uint16_t gateway, uint16_t hops, Time delay);
+
+  /**
+   * \returns the number of records written
+   */
+  uint64_t GetNRecords (void) const;
+
+private:
+  /**
+   * \brief Write the records in memory as a chunk.
+   */
+  void WriteChunk (void);
+
+  std::ofstream m_file;                 //!< the file
+  uint32_t m_chunkSize;                 //!< the number of records of a full chunk
+  uint64_t m_nRecords;                  //!< the number of records written
+  std::vector<int64_t> m_time;          //!< the time column of the chunk
+  std::vector<double> m_delay;          //!< the delay column of the chunk
+  std::vector<uint16_t> m_osid;         //!< the osid column of the chunk
+  std::vector<uint16_t> m_did;          //!< the did column of the chunk
+  std::vector<uint16_t> m_gateway;      //!< the gateway column of the chunk
+  std::vector<uint16_t> m_hops;         //!< the hops column of the chunk
+};
+
+/**
+ * \brief Map a file written by LwsnDeliveryWriter
+ *
+ * The columns of each chunk are returned as pointers into the mapped
+ * file, without copying nor parsing the records.
+ */
+class LwsnDeliveryReader
+{
+public:
+  /**
+   * \brief The columns of a chunk
+   */
+  struct Chunk
+  {
+    uint32_t m_nRecords;         //!< the number of records
+    const int64_t *m_time;       //!< the delivery times, in nanoseconds
+    const double *m_delay;       //!< the delays, in seconds
+    const uint16_t *m_osid;      //!< the osids
+    const uint16_t *m_did;       //!< the dids
+    const uint16_t *m_gateway;   //!< the gateway ids
+    const uint16_t *m_hops;      //!< the numbers of hops
+  };
+
+  LwsnDeliveryReader ();
+
+  /**
+   * \brief Map a file and index its chunks.
+   *
+   * A chunk cut short by the end of the file is ignored.
+   *
+   * \param filename the name of the file
+   * \returns false if the file is not a delivery file of this host
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * \brief Unmap the file.
+   */
+  void Close (void);
+
+  /**
+   * \returns the number of records of the file
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \returns the number of chunks of the file
+   */
+  uint32_t GetNChunks (void) const;
+
+  /**
+   * \param index the number of the chunk, from 0
+   * \returns the columns of the chunk, valid until the file is closed
+   */
+  Chunk GetChunk (uint32_t index) const;
+
+private:
+  MappedFile m_file;              //!< the mapped file
+  std::vector<Chunk> m_chunks;    //!< the chunks of the file
+  uint64_t m_nRecords;            //!< the number of records
+};
+
+} // namespace ns3
+
+#endif /* LWSN_DELIVERY_STORE_H */
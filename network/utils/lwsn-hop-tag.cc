@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lwsn-hop-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LwsnHopTag");
+
+NS_OBJECT_ENSURE_REGISTERED (LwsnHopTag);
+
+TypeId
+LwsnHopTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LwsnHopTag")
+    .SetParent<Tag> ()
+    .SetGroupName("Network")
+    .AddConstructor<LwsnHopTag> ()
+  ;
+  return tid;
+}
+TypeId
+LwsnHopTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+LwsnHopTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 2;
+}
+void
+LwsnHopTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU16 (m_forwards);
+}
+void
+LwsnHopTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_forwards = buf.ReadU16 ();
+}
+void
+LwsnHopTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "Forwards=" << m_forwards;
+}
+LwsnHopTag::LwsnHopTag ()
+  : Tag (),
+    m_forwards (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LwsnHopTag::SetForwards (uint16_t forwards)
+{
+  NS_LOG_FUNCTION (this << forwards);
+  m_forwards = forwards;
+}
+uint16_t
+LwsnHopTag::GetForwards (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_forwards;
+}
+
+} // namespace ns3
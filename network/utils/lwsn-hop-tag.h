@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LWSN_HOP_TAG_H
+#define LWSN_HOP_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \brief Count the sensors which forwarded an LWSN packet
+ *
+ * The LwsnHeader is rebuilt by every forwarding sensor and has no room
+ * for a hop count, so the count travels in a packet tag instead: it is
+ * incremented by SimpleNetDevice::Forwarding, and read by the gateway.
+ */
+class LwsnHopTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  LwsnHopTag ();
+
+  /**
+   * \param forwards the number of sensors which forwarded the packet
+   */
+  void SetForwards (uint16_t forwards);
+  /**
+   * \returns the number of sensors which forwarded the packet
+   */
+  uint16_t GetForwards (void) const;
+private:
+  uint16_t m_forwards; //!< number of sensors which forwarded the packet
+};
+
+} // namespace ns3
+
+#endif /* LWSN_HOP_TAG_H */
@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lwsn-send-time-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LwsnSendTimeTag");
+
+NS_OBJECT_ENSURE_REGISTERED (LwsnSendTimeTag);
+
+TypeId
+LwsnSendTimeTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LwsnSendTimeTag")
+    .SetParent<Tag> ()
+    .SetGroupName("Network")
+    .AddConstructor<LwsnSendTimeTag> ()
+  ;
+  return tid;
+}
+TypeId
+LwsnSendTimeTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+LwsnSendTimeTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 8;
+}
+void
+LwsnSendTimeTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU64 (m_sendTime.GetNanoSeconds ());
+}
+void
+LwsnSendTimeTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_sendTime = NanoSeconds (buf.ReadU64 ());
+}
+void
+LwsnSendTimeTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "SendTime=" << m_sendTime;
+}
+LwsnSendTimeTag::LwsnSendTimeTag ()
+  : Tag ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LwsnSendTimeTag::SetSendTime (Time sendTime)
+{
+  NS_LOG_FUNCTION (this << sendTime);
+  m_sendTime = sendTime;
+}
+Time
+LwsnSendTimeTag::GetSendTime (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendTime;
+}
+
+} // namespace ns3
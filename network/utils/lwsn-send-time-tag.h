@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LWSN_SEND_TIME_TAG_H
+#define LWSN_SEND_TIME_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief Record when an LWSN packet was first sent
+ *
+ * The start time of the LwsnHeader only holds whole seconds, so the
+ * exact time travels in a packet tag instead: it is set by the sensor
+ * originating the packet, kept by the forwarding sensors, and read by
+ * the gateway to compute the delivery delay.
+ */
+class LwsnSendTimeTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  LwsnSendTimeTag ();
+
+  /**
+   * \param sendTime the time the packet was first sent
+   */
+  void SetSendTime (Time sendTime);
+  /**
+   * \returns the time the packet was first sent
+   */
+  Time GetSendTime (void) const;
+private:
+  Time m_sendTime; //!< the time the packet was first sent
+};
+
+} // namespace ns3
+
+#endif /* LWSN_SEND_TIME_TAG_H */
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/lwsn-header.h"
+#include "lwsn-sensor-application.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LwsnSensorApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (LwsnSensorApplication);
+
+TypeId
+LwsnSensorApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LwsnSensorApplication")
+    .SetParent<Application> ()
+    .SetGroupName("Network")
+    .AddConstructor<LwsnSensorApplication> ()
+    .AddAttribute ("TrafficModel",
+                   "The process the readings follow.",
+                   EnumValue (LwsnSensorApplication::PERIODIC),
+                   MakeEnumAccessor (&LwsnSensorApplication::m_model),
+                   MakeEnumChecker (LwsnSensorApplication::PERIODIC, "Periodic",
+                                    LwsnSensorApplication::POISSON, "Poisson",
+                                    LwsnSensorApplication::BURSTY, "Bursty"))
+    .AddAttribute ("Interval",
+                   "The time between readings (Periodic), or its mean (Poisson), "
+                   "or the mean time between bursts (Bursty).",
+                   TimeValue (Seconds (10.0)),
+                   MakeTimeAccessor (&LwsnSensorApplication::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("BurstSize",
+                   "The number of readings of a burst (Bursty).",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&LwsnSensorApplication::m_burstSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BurstSpacing",
+                   "The time between the readings of a burst (Bursty).",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&LwsnSensorApplication::m_burstSpacing),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxPackets",
+                   "The maximum number of readings the application will send (zero means infinite)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&LwsnSensorApplication::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PacketSize",
+                   "Size of the readings (bytes).",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&LwsnSensorApplication::m_size),
+                   MakeUintegerChecker<uint32_t> (LwsnHeader ().GetSerializedSize ()))
+    .AddTraceSource ("Tx", "A reading has been handed to the device",
+                     MakeTraceSourceAccessor (&LwsnSensorApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Drop", "A reading has been refused by the device",
+                     MakeTraceSourceAccessor (&LwsnSensorApplication::m_dropTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+LwsnSensorApplication::LwsnSensorApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  m_sent = 0;
+  m_burstLeft = 0;
+  m_device = 0;
+  m_sendEvent = EventId ();
+  m_arrival = CreateObject<ExponentialRandomVariable> ();
+}
+
+LwsnSensorApplication::~LwsnSensorApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LwsnSensorApplication::SetDevice (Ptr<SimpleNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_device = device;
+}
+
+uint32_t
+LwsnSensorApplication::GetSent (void) const
+{
+  return m_sent;
+}
+
+int64_t
+LwsnSensorApplication::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_arrival->SetStream (stream);
+  return 1;
+}
+
+void
+LwsnSensorApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_device = 0;
+  Application::DoDispose ();
+}
+
+void
+LwsnSensorApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_device == 0)
+    {
+      Ptr<Node> node = GetNode ();
+      for (uint32_t i = 0; i < node->GetNDevices () && m_device == 0; i++)
+        {
+          m_device = DynamicCast<SimpleNetDevice> (node->GetDevice (i));
+        }
+      NS_ASSERT_MSG (m_device != 0, "No SimpleNetDevice on node " << node->GetId ());
+    }
+
+  m_arrival->SetAttribute ("Mean", DoubleValue (m_interval.GetSeconds ()));
+  m_burstLeft = 0;
+  ScheduleNext ();
+}
+
+void
+LwsnSensorApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+}
+
+void
+LwsnSensorApplication::ScheduleNext (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_maxPackets != 0 && m_sent >= m_maxPackets)
+    {
+      return;
+    }
+
+  Time delay;
+  if (m_burstLeft > 0)
+    {
+      delay = m_burstSpacing;
+    }
+  else if (m_model == PERIODIC)
+    {
+      delay = m_interval;
+    }
+  else
+    {
+      delay = Seconds (m_arrival->GetValue ());
+    }
+  m_sendEvent = Simulator::Schedule (delay, &LwsnSensorApplication::Send, this);
+}
+
+void
+LwsnSensorApplication::Send (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_model == BURSTY && m_burstLeft == 0)
+    {
+      m_burstLeft = m_burstSize;
+    }
+
+  // a packet of its own for every reading, so that each has its own uid;
+  // the headroom takes the header added by the device without a copy
+  Ptr<Packet> packet = Packet::CreateWithHeadroom (m_size, m_device->GetHeadroom ());
+  m_sent++;
+  if (m_device->OriginalTransmission (packet, false))
+    {
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+                   << "s sensor " << m_device->GetSid () << " sent reading " << m_sent);
+      m_txTrace (packet);
+    }
+  else
+    {
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+                   << "s sensor " << m_device->GetSid () << " dropped reading " << m_sent);
+      m_dropTrace (packet);
+    }
+
+  if (m_burstLeft > 0)
+    {
+      m_burstLeft--;
+    }
+  ScheduleNext ();
+}
+
+} // namespace ns3
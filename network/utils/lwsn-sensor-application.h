@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LWSN_SENSOR_APPLICATION_H
+#define LWSN_SENSOR_APPLICATION_H
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class Packet;
+class SimpleNetDevice;
+class ExponentialRandomVariable;
+
+/**
+ * \ingroup network
+ *
+ * \brief A sensor of a linear wireless sensor network.
+ *
+ * The application hands its readings to the SimpleNetDevice of its node
+ * with SimpleNetDevice::OriginalTransmission. The next reading is drawn
+ * only when the current one is sent, so that a sensor never has more than
+ * one pending event, whatever the length of the simulation.
+ *
+ * The readings follow one of three models:
+ *  - PERIODIC: one reading every `Interval';
+ *  - POISSON: readings separated by exponential times of mean `Interval';
+ *  - BURSTY: events separated by exponential times of mean `Interval',
+ *    each of which produces `BurstSize' readings `BurstSpacing' apart.
+ *
+ * The application stops after `MaxPackets' readings (zero means infinite),
+ * or at its stop time. The readings refused by the device, when its
+ * queue is stopped, are reported through the "Drop" trace source.
+ */
+class LwsnSensorApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// Traffic models
+  enum TrafficModel
+  {
+    PERIODIC,     //!< Constant inter-reading time
+    POISSON,      //!< Exponential inter-reading time
+    BURSTY        //!< Bursts of readings at exponential times
+  };
+
+  LwsnSensorApplication ();
+
+  virtual ~LwsnSensorApplication ();
+
+  /**
+   * \brief Set the device the readings are sent through.
+   *
+   * By default, the first SimpleNetDevice of the node is used.
+   *
+   * \param device the device
+   */
+  void SetDevice (Ptr<SimpleNetDevice> device);
+
+  /**
+   * \returns the number of readings generated so far, sent or dropped
+   */
+  uint32_t GetSent (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this application.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this application
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Schedule the next reading.
+   */
+  void ScheduleNext (void);
+
+  /**
+   * \brief Send a reading and schedule the next one.
+   */
+  void Send (void);
+
+  TrafficModel m_model;  //!< Traffic model
+  Time m_interval;       //!< Inter-reading time, or its mean
+  uint32_t m_burstSize;  //!< Readings per burst
+  Time m_burstSpacing;   //!< Time between the readings of a burst
+  uint32_t m_maxPackets; //!< Maximum number of readings the application will send
+  uint32_t m_size;       //!< Size of the readings
+
+  uint32_t m_sent;       //!< Counter for generated readings
+  uint32_t m_burstLeft;  //!< Readings left in the current burst
+  Ptr<SimpleNetDevice> m_device; //!< The device the readings are sent through
+  Ptr<ExponentialRandomVariable> m_arrival; //!< Exponential inter-arrival times
+  EventId m_sendEvent;   //!< Event to send the next reading
+
+  /// Traced Callback: sent readings.
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  /// Traced Callback: readings refused by the device.
+  TracedCallback<Ptr<const Packet> > m_dropTrace;
+};
+
+} // namespace ns3
+
+#endif /* LWSN_SENSOR_APPLICATION_H */
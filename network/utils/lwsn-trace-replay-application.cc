@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/lwsn-header.h"
+#include "lwsn-trace-replay-application.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LwsnTraceReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (LwsnTraceReplayApplication);
+
+const uint32_t BINARY_MAGIC = 0x4c575452;        /**< Magic number of a binary trace */
+const uint32_t BINARY_VERSION = 1;               /**< Version of the binary trace format */
+const uint32_t BINARY_HEADER_SIZE = 8;           /**< Size of the binary trace header */
+const uint32_t BINARY_RECORD_SIZE = 16;          /**< Size of a binary trace record */
+const uint64_t RELEASE_CHUNK = 1 << 20;          /**< Amount of binary trace released at once */
+const uint32_t RELEASE_RECORDS = 4096;           /**< Number of pcap records released at once */
+
+/**
+ * \param data the bytes to read
+ * \returns the 32 bit value at data, in host byte order
+ */
+static uint32_t
+Read32 (const uint8_t *data)
+{
+  uint32_t v;
+  memcpy (&v, data, sizeof (v));
+  return v;
+}
+
+TypeId
+LwsnTraceReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LwsnTraceReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName("Network")
+    .AddConstructor<LwsnTraceReplayApplication> ()
+    .AddAttribute ("Filename",
+                   "The name of the pcap or binary trace to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&LwsnTraceReplayApplication::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("SidOffset",
+                   "The offset of the big-endian sensor id in the packets of a pcap trace.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&LwsnTraceReplayApplication::m_sidOffset),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Rebase",
+                   "Replay the first record at the start time of the application, "
+                   "instead of at its time in the trace.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&LwsnTraceReplayApplication::m_rebase),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Tx", "A reading has been handed to the device",
+                     MakeTraceSourceAccessor (&LwsnTraceReplayApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Drop", "A reading has been refused by the device",
+                     MakeTraceSourceAccessor (&LwsnTraceReplayApplication::m_dropTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+LwsnTraceReplayApplication::LwsnTraceReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  m_offset = 0;
+  m_record = 0;
+  m_pcap = false;
+  m_replayed = 0;
+  m_skipped = 0;
+  m_replayEvent = EventId ();
+}
+
+LwsnTraceReplayApplication::~LwsnTraceReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LwsnTraceReplayApplication::AddSensor (Ptr<SimpleNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_sensors[device->GetSid ()] = device;
+}
+
+uint32_t
+LwsnTraceReplayApplication::GetReplayed (void) const
+{
+  return m_replayed;
+}
+
+uint32_t
+LwsnTraceReplayApplication::GetSkipped (void) const
+{
+  return m_skipped;
+}
+
+void
+LwsnTraceReplayApplication::WriteBinaryHeader (std::ostream &os)
+{
+  os.write (reinterpret_cast<const char *> (&BINARY_MAGIC), sizeof (BINARY_MAGIC));
+  os.write (reinterpret_cast<const char *> (&BINARY_VERSION), sizeof (BINARY_VERSION));
+}
+
+void
+LwsnTraceReplayApplication::WriteBinaryRecord (std::ostream &os, Time time, uint16_t sid, uint32_t size)
+{
+  uint8_t record[BINARY_RECORD_SIZE];
+  uint64_t ns = time.GetNanoSeconds ();
+  uint16_t padding = 0;
+  memcpy (record, &ns, 8);
+  memcpy (record + 8, &sid, 2);
+  memcpy (record + 10, &padding, 2);
+  memcpy (record + 12, &size, 4);
+  os.write (reinterpret_cast<const char *> (record), sizeof (record));
+}
+
+void
+LwsnTraceReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sensors.clear ();
+  m_file.Close ();
+  m_reader.Close ();
+  Application::DoDispose ();
+}
+
+void
+LwsnTraceReplayApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_reader.OpenSequential (m_filename))
+    {
+      m_pcap = true;
+      m_record = 0;
+      m_reader.AdviseSequential ();
+    }
+  else
+    {
+      NS_ABORT_MSG_UNLESS (m_file.Open (m_filename), "Cannot open trace " << m_filename);
+      const uint8_t *data = m_file.GetData ();
+      uint32_t magic = m_file.GetSize () >= 4 ? Read32 (data) : 0;
+      NS_ABORT_MSG_UNLESS (magic == BINARY_MAGIC, "Unknown trace format " << m_filename);
+      NS_ABORT_MSG_IF (m_file.GetSize () < BINARY_HEADER_SIZE
+                       || Read32 (data + 4) != BINARY_VERSION,
+                       "Unsupported binary trace " << m_filename);
+      m_pcap = false;
+      m_offset = BINARY_HEADER_SIZE;
+      m_file.AdviseSequential ();
+    }
+
+  if (ReadRecord (m_next))
+    {
+      m_base = m_rebase ? Simulator::Now () - m_next.time : Time (0);
+      ScheduleReplay ();
+    }
+}
+
+void
+LwsnTraceReplayApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_replayEvent);
+}
+
+bool
+LwsnTraceReplayApplication::ReadRecord (Record &record)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_pcap)
+    {
+      if (m_offset + BINARY_RECORD_SIZE > m_file.GetSize ())
+        {
+          return false;
+        }
+      const uint8_t *data = m_file.GetData () + m_offset;
+      uint64_t ns;
+      memcpy (&ns, data, 8);
+      memcpy (&record.sid, data + 8, 2);
+      memcpy (&record.size, data + 12, 4);
+      record.time = NanoSeconds (ns);
+      m_offset += BINARY_RECORD_SIZE;
+      // the records before are never read again
+      m_file.Release (m_offset - m_offset % RELEASE_CHUNK);
+      return true;
+    }
+
+  PcapFileReader::Record pcap;
+  while (m_reader.ReadNext (pcap))
+    {
+      if (++m_record % RELEASE_RECORDS == 0)
+        {
+          // the records before are never read again
+          m_reader.ReleaseRead ();
+        }
+      if (pcap.m_inclLen < m_sidOffset + 2)
+        {
+          NS_LOG_LOGIC ("Record " << m_record - 1 << " without sensor id");
+          m_skipped++;
+          continue;
+        }
+      record.time = Seconds (pcap.m_tsSec)
+        + (m_reader.IsNanoSecMode () ? NanoSeconds (pcap.m_tsUsec) : MicroSeconds (pcap.m_tsUsec));
+      record.sid = (pcap.m_data[m_sidOffset] << 8) | pcap.m_data[m_sidOffset + 1];
+      record.size = pcap.m_origLen;
+      return true;
+    }
+  return false;
+}
+
+void
+LwsnTraceReplayApplication::ScheduleReplay (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time at = m_base + m_next.time;
+  Time delay = std::max (at - Simulator::Now (), Time (0));
+  m_replayEvent = Simulator::Schedule (delay, &LwsnTraceReplayApplication::Replay, this);
+}
+
+void
+LwsnTraceReplayApplication::Replay (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::map<uint16_t, Ptr<SimpleNetDevice> >::const_iterator i = m_sensors.find (m_next.sid);
+  if (i == m_sensors.end ())
+    {
+      NS_LOG_LOGIC ("No sensor " << m_next.sid);
+      m_skipped++;
+    }
+  else
+    {
+      Ptr<SimpleNetDevice> device = i->second;
+      // the device replaces the first bytes of the reading with its header
+      uint32_t size = std::max (m_next.size, LwsnHeader ().GetSerializedSize ());
+      Ptr<Packet> packet = Packet::CreateWithHeadroom (size, device->GetHeadroom ());
+      m_replayed++;
+      if (device->OriginalTransmission (packet, false))
+        {
+          m_txTrace (packet);
+        }
+      else
+        {
+          m_dropTrace (packet);
+        }
+    }
+
+  if (ReadRecord (m_next))
+    {
+      ScheduleReplay ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LWSN_TRACE_REPLAY_APPLICATION_H
+#define LWSN_TRACE_REPLAY_APPLICATION_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+#include "ns3/mapped-file.h"
+#include "ns3/pcap-file-reader.h"
+
+namespace ns3 {
+
+class Packet;
+class SimpleNetDevice;
+
+/**
+ * \ingroup network
+ *
+ * \brief Replay the readings of a captured trace on the sensors of a
+ * linear wireless sensor network.
+ *
+ * The trace is a list of (time, sensor id, size) records, in time
+ * order, which is read from either
+ *  - a pcap file: the time and the size of a reading are those of the
+ *    packet record, and the sensor id is the big-endian 16 bit value at
+ *    `SidOffset' in the captured bytes (by default, the Osid field of an
+ *    LwsnHeader at the start of the packet);
+ *  - a binary trace: a header made of the 32 bit magic number 0x4c575452
+ *    and the 32 bit version 1, followed by 16 byte records holding the
+ *    time in nanoseconds (64 bits), the sensor id (16 bits), 16 bits of
+ *    padding and the size (32 bits), all in host byte order. The
+ *    WriteBinaryHeader and WriteBinaryRecord methods write such a trace.
+ *
+ * The format is detected from the magic number of the file.
+ *
+ * The file is mapped in memory and the records are read one at a time:
+ * the next record is read only when the current one is replayed, and
+ * the pages of the file which have been read are released, so that the
+ * file is never resident in memory as a whole. A pcap trace is read with
+ * a PcapFileReader opened with OpenSequential, which does not index the
+ * records, so the memory used does not grow with the trace.
+ *
+ * Each reading is handed to the SimpleNetDevice whose sid matches the
+ * sensor id of the record, with SimpleNetDevice::OriginalTransmission.
+ * The readings of unknown sensors are skipped.
+ */
+class LwsnTraceReplayApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  LwsnTraceReplayApplication ();
+
+  virtual ~LwsnTraceReplayApplication ();
+
+  /**
+   * \brief Replay the readings of a sensor through a device.
+   *
+   * The device is identified by its sid.
+   *
+   * \param device the device
+   */
+  void AddSensor (Ptr<SimpleNetDevice> device);
+
+  /**
+   * \returns the number of readings replayed so far, sent or dropped
+   */
+  uint32_t GetReplayed (void) const;
+  /**
+   * \returns the number of readings skipped so far
+   */
+  uint32_t GetSkipped (void) const;
+
+  /**
+   * \brief Write the header of a binary trace.
+   *
+   * \param os the stream to write to
+   */
+  static void WriteBinaryHeader (std::ostream &os);
+  /**
+   * \brief Write a record of a binary trace.
+   *
+   * \param os the stream to write to
+   * \param time the time of the reading
+   * \param sid the sensor id
+   * \param size the size of the reading
+   */
+  static void WriteBinaryRecord (std::ostream &os, Time time, uint16_t sid, uint32_t size);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief A trace record
+   */
+  struct Record
+  {
+    Time time;     //!< the time of the reading in the trace
+    uint16_t sid;  //!< the sensor id
+    uint32_t size; //!< the size of the reading
+  };
+
+  /**
+   * \brief Read the next record of the trace.
+   *
+   * \param record the record read
+   * \returns false at the end of the trace
+   */
+  bool ReadRecord (Record &record);
+  /**
+   * \brief Schedule the replay of the record read last.
+   */
+  void ScheduleReplay (void);
+  /**
+   * \brief Replay the current record and schedule the next one.
+   */
+  void Replay (void);
+
+  std::string m_filename; //!< the name of the trace
+  uint32_t m_sidOffset;   //!< the offset of the sensor id in the pcap records
+  bool m_rebase;          //!< replay the first record at the start time
+
+  PcapFileReader m_reader; //!< the pcap trace
+  uint32_t m_record;      //!< the number of pcap records read
+  MappedFile m_file;      //!< the binary trace
+  uint64_t m_offset;      //!< the offset of the next binary record
+  bool m_pcap;            //!< true for a pcap trace, false for a binary trace
+  Time m_base;            //!< the simulation time of the trace time 0
+  Record m_next;          //!< the record to replay next
+  uint32_t m_replayed;    //!< Counter for replayed readings
+  uint32_t m_skipped;     //!< Counter for skipped readings
+  std::map<uint16_t, Ptr<SimpleNetDevice> > m_sensors; //!< the devices, by sid
+  EventId m_replayEvent;  //!< Event to replay the next record
+
+  /// Traced Callback: sent readings.
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  /// Traced Callback: readings refused by the device.
+  TracedCallback<Ptr<const Packet> > m_dropTrace;
+};
+
+} // namespace ns3
+
+#endif /* LWSN_TRACE_REPLAY_APPLICATION_H */
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ns3/log.h"
+#include "mapped-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MappedFile");
+
+MappedFile::MappedFile ()
+  : m_data (0),
+    m_size (0),
+    m_released (0),
+    m_open (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MappedFile::~MappedFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+MappedFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Cannot open " << filename);
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0)
+    {
+      NS_LOG_WARN ("Cannot stat " << filename);
+      close (fd);
+      return false;
+    }
+  m_size = st.st_size;
+  if (m_size > 0)
+    {
+      void *data = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED)
+        {
+          NS_LOG_WARN ("Cannot map " << filename);
+          close (fd);
+          m_size = 0;
+          return false;
+        }
+      m_data = static_cast<uint8_t *> (data);
+    }
+  // the mapping outlives the descriptor
+  close (fd);
+  m_released = 0;
+  m_open = true;
+  return true;
+}
+
+void
+MappedFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+      munmap (m_data, m_size);
+    }
+  m_data = 0;
+  m_size = 0;
+  m_released = 0;
+  m_open = false;
+}
+
+bool
+MappedFile::IsOpen (void) const
+{
+  return m_open;
+}
+
+const uint8_t *
+MappedFile::GetData (void) const
+{
+  return m_data;
+}
+
+uint64_t
+MappedFile::GetSize (void) const
+{
+  return m_size;
+}
+
+void
+MappedFile::AdviseSequential (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+      madvise (m_data, m_size, MADV_SEQUENTIAL);
+    }
+}
+
+void
+MappedFile::Release (uint64_t offset)
+{
+  NS_LOG_FUNCTION (this << offset);
+  uint64_t pageSize = sysconf (_SC_PAGESIZE);
+  // only the whole pages before the offset can go
+  uint64_t end = offset - offset % pageSize;
+  if (m_data == 0 || end <= m_released)
+    {
+      return;
+    }
+  madvise (m_data + m_released, end - m_released, MADV_DONTNEED);
+  m_released = end;
+}
+
+} // namespace ns3
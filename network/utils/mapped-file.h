@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief A read-only file mapped into memory.
+ *
+ * The file contents are accessed in place: the pages are read from the
+ * disk when they are first touched, and belong to the page cache, so
+ * that mapping a file of many gigabytes costs no heap memory. A reader
+ * which goes through the file once can release the pages it is done
+ * with, to keep its resident memory constant.
+ */
+class MappedFile
+{
+public:
+  MappedFile ();
+  /**
+   * Unmap the file.
+   */
+  ~MappedFile ();
+
+  /**
+   * \brief Map a file.
+   *
+   * \param filename the name of the file
+   * \returns true if the file has been mapped, false otherwise
+   */
+  bool Open (std::string const &filename);
+  /**
+   * \brief Unmap the file, if any.
+   */
+  void Close (void);
+  /**
+   * \returns true if a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \returns the contents of the file, 0 if the file is empty
+   */
+  const uint8_t *GetData (void) const;
+  /**
+   * \returns the size of the file, in bytes
+   */
+  uint64_t GetSize (void) const;
+
+  /**
+   * \brief Hint that the file will be read in order.
+   */
+  void AdviseSequential (void);
+  /**
+   * \brief Release the pages before an offset.
+   *
+   * The pages are read again from the file if they are accessed later.
+   *
+   * \param offset the offset of the first byte still needed
+   */
+  void Release (uint64_t offset);
+
+private:
+  /**
+   * \brief Copy constructor, not implemented.
+   * \param o object to copy
+   */
+  MappedFile (const MappedFile &o);
+  /**
+   * \brief Assignment operator, not implemented.
+   * \param o object to copy
+   * \returns this object
+   */
+  MappedFile &operator = (const MappedFile &o);
+
+  uint8_t *m_data;     //!< the mapped contents
+  uint64_t m_size;     //!< the size of the file
+  uint64_t m_released; //!< the offset the pages are released up to
+  bool m_open;         //!< true if a file is mapped
+};
+
+} // namespace ns3
+
+#endif /* MAPPED_FILE_H */
@@ -17,17 +17,80 @@
  */
 
 #include "output-stream-wrapper.h"
+#include "async-file-writer.h"
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include "ns3/simulator.h"
 #include <fstream>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
+/**
+ * \brief A stream buffer copying the characters written to an AsyncFileWriter
+ *
+ * The buffer has no memory of its own: the characters are copied
+ * directly into the blocks of the writer, which only takes a lock when
+ * a block is full.
+ *
+ * Flushing the stream of a draining buffer waits for the writer thread
+ * to write everything; such a stream is registered with FatalImpl, so
+ * that nothing written is lost on a fatal error.
+ */
+class AsyncStreamBuffer : public std::streambuf
+{
+public:
+  /**
+   * \param writer the writer to copy to
+   * \param drain true to wait for the writer thread when synchronized
+   */
+  AsyncStreamBuffer (AsyncFileWriter *writer, bool drain)
+    : m_writer (writer),
+      m_drain (drain)
+  {
+  }
+
+protected:
+  virtual int_type overflow (int_type c)
+  {
+    if (!traits_type::eq_int_type (c, traits_type::eof ()))
+      {
+        uint8_t byte = traits_type::to_char_type (c);
+        m_writer->Write (&byte, 1);
+      }
+    return traits_type::not_eof (c);
+  }
+
+  virtual std::streamsize xsputn (const char *s, std::streamsize n)
+  {
+    m_writer->Write (reinterpret_cast<const uint8_t *> (s), n);
+    return n;
+  }
+
+  virtual int sync (void)
+  {
+    if (m_drain)
+      {
+        m_writer->Flush ();
+      }
+    // otherwise the blocks are written by the writer thread when full
+    return 0;
+  }
+
+private:
+  AsyncFileWriter *m_writer; //!< the writer to copy to
+  bool m_drain;              //!< true to wait for the writer thread when synchronized
+};
+
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_destroyable (true),
+    m_writer (0),
+    m_asyncBuffer (0),
+    m_asyncStream (0),
+    m_fatalBuffer (0),
+    m_fatalStream (0)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
   std::ofstream* os = new std::ofstream ();
@@ -39,7 +102,12 @@ OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmo
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_destroyable (false),
+    m_writer (0),
+    m_asyncBuffer (0),
+    m_asyncStream (0),
+    m_fatalBuffer (0),
+    m_fatalStream (0)
 {
   NS_LOG_FUNCTION (this << os);
   FatalImpl::RegisterStream (m_ostream);
@@ -49,7 +117,20 @@ OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::UnregisterStream (m_ostream);
+  if (m_writer != 0)
+    {
+      FatalImpl::UnregisterStream (m_fatalStream);
+      delete m_fatalStream;
+      delete m_fatalBuffer;
+      delete m_asyncStream;
+      delete m_asyncBuffer;
+      // writes the pending blocks before the stream is closed
+      delete m_writer;
+    }
+  else
+    {
+      FatalImpl::UnregisterStream (m_ostream);
+    }
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
 }
@@ -58,7 +139,40 @@ std::ostream *
 OutputStreamWrapper::GetStream (void)
 {
   NS_LOG_FUNCTION (this);
-  return m_ostream;
+  return m_writer != 0 ? m_asyncStream : m_ostream;
+}
+
+void
+OutputStreamWrapper::EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks)
+{
+  NS_LOG_FUNCTION (this << blockSize << maxBlocks);
+  NS_ASSERT (m_writer == 0);
+  m_ostream->flush ();
+  // the wrapped stream now belongs to the writer thread: on a fatal
+  // error, it is flushed by waiting for the writer thread instead
+  FatalImpl::UnregisterStream (m_ostream);
+  m_writer = new AsyncFileWriter (m_ostream, blockSize, maxBlocks);
+  m_asyncBuffer = new AsyncStreamBuffer (m_writer, false);
+  m_asyncStream = new std::ostream (m_asyncBuffer);
+  m_fatalBuffer = new AsyncStreamBuffer (m_writer, true);
+  m_fatalStream = new std::ostream (m_fatalBuffer);
+  FatalImpl::RegisterStream (m_fatalStream);
+  // the event keeps this wrapper alive until the simulation ends
+  Simulator::ScheduleDestroy (&OutputStreamWrapper::Flush, Ptr<OutputStreamWrapper> (this));
+}
+
+void
+OutputStreamWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Flush ();
+    }
+  else
+    {
+      m_ostream->flush ();
+    }
 }
 
 } // namespace ns3
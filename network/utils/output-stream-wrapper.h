@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class AsyncFileWriter;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -92,9 +94,43 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * \brief Write the stream from a background thread.
+   *
+   * The stream returned by GetStream from now on only copies what is
+   * written to it into blocks of memory, and a writer thread writes the
+   * full blocks to the wrapped stream (see AsyncFileWriter), so that
+   * the file I/O overlaps with the simulation.  With two blocks, one is
+   * filled while the other is written; the caller only waits when
+   * every block is waiting for the writer thread.  Flushing the
+   * returned stream, e.g. with std::endl, does not wait for the writer
+   * thread: use Flush instead.
+   *
+   * The stream must be switched before any trace sink keeps the
+   * pointer returned by GetStream.  Everything written is flushed at
+   * Simulator::Destroy, when the wrapper is destroyed, and on a fatal
+   * error.
+   *
+   * \param blockSize the size of the blocks, in bytes
+   * \param maxBlocks the number of blocks; at least 2
+   */
+  void EnableAsyncWrite (uint32_t blockSize = 65536, uint32_t maxBlocks = 2);
+
+  /**
+   * \brief Write everything written so far to the wrapped stream, and flush it.
+   *
+   * When the writes are asynchronous, this waits for the writer thread.
+   */
+  void Flush (void);
+
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  AsyncFileWriter *m_writer; //!< the writer thread, 0 to write synchronously
+  std::streambuf *m_asyncBuffer; //!< the buffer copying to the writer thread
+  std::ostream *m_asyncStream; //!< the stream returned when the writes are asynchronous
+  std::streambuf *m_fatalBuffer; //!< the buffer waiting for the writer thread when flushed
+  std::ostream *m_fatalStream; //!< the stream flushed by FatalImpl when the writes are asynchronous
 };
 
 } // namespace ns3
@@ -110,22 +110,31 @@ void
 PacketSocketServer::HandleRead (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
-  Ptr<Packet> packet;
-  Address from;
-  while ((packet = socket->RecvFrom (from)))
+  Ptr<PacketSocket> packetSocket = DynamicCast<PacketSocket> (socket);
+  NS_ASSERT (packetSocket != 0);
+  // drain the receive queue a few packets at a time
+  m_rxBatch.clear ();
+  while (packetSocket->RecvBatch (64, m_rxBatch) > 0)
     {
-      if (PacketSocketAddress::IsMatchingType (from))
+      for (std::vector<std::pair<Ptr<Packet>, Address> >::const_iterator i = m_rxBatch.begin ();
+           i != m_rxBatch.end (); ++i)
         {
-          m_pktRx ++;
-          m_bytesRx += packet->GetSize ();
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
-                       << "s packet sink received "
-                       << packet->GetSize () << " bytes from "
-                       << PacketSocketAddress::ConvertFrom (from)
-                       << " total Rx " << m_pktRx << " packets"
-                       << " and " << m_bytesRx << " bytes");
-          m_rxTrace (packet, from);
+          Ptr<Packet> packet = i->first;
+          const Address &from = i->second;
+          if (PacketSocketAddress::IsMatchingType (from))
+            {
+              m_pktRx ++;
+              m_bytesRx += packet->GetSize ();
+              NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+                           << "s packet sink received "
+                           << packet->GetSize () << " bytes from "
+                           << PacketSocketAddress::ConvertFrom (from)
+                           << " total Rx " << m_pktRx << " packets"
+                           << " and " << m_bytesRx << " bytes");
+              m_rxTrace (packet, from);
+            }
         }
+      m_rxBatch.clear ();
     }
 }
 
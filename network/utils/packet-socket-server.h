@@ -21,6 +21,7 @@
 #ifndef PACKET_SOCKET_SERVER_H
 #define PACKET_SOCKET_SERVER_H
 
+#include <vector>
 #include "ns3/application.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
@@ -80,6 +81,7 @@ private:
   uint32_t m_bytesRx;  //!< Total bytes received
 
   Ptr<Socket> m_socket; //!< Socket
+  std::vector<std::pair<Ptr<Packet>, Address> > m_rxBatch; //!< Packets read by HandleRead
   PacketSocketAddress m_localAddress; //!< Local address
   bool m_localAddressSet; //!< Sanity check
 
@@ -25,6 +25,8 @@
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
 
 #include <algorithm>
@@ -50,6 +52,12 @@ PacketSocket::GetTypeId (void)
                    UintegerValue (131072),
                    MakeUintegerAccessor (&PacketSocket::m_rcvBufSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CoalesceDataRecv",
+                   "Notify the application once for all the packets received "
+                   "during an event, instead of once per packet.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PacketSocket::m_coalesceDataRecv),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -63,6 +71,7 @@ PacketSocket::PacketSocket () : m_rxAvailable (0)
   m_errno = ERROR_NOTERROR;
   m_isSingleDevice = false;
   m_device = 0;
+  m_coalesceDataRecv = false;
 }
 
 void 
@@ -81,6 +90,7 @@ void
 PacketSocket::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_dataRecvEvent.Cancel ();
   m_device = 0;
 }
 
@@ -413,7 +423,15 @@ PacketSocket::ForwardUp (Ptr<NetDevice> device, Ptr<const Packet> packet,
       m_deliveryQueue.push (std::make_pair (copy, address));
       m_rxAvailable += packet->GetSize ();
       NS_LOG_LOGIC ("UID is " << packet->GetUid () << " PacketSocket " << this);
-      NotifyDataRecv ();
+      if (!m_coalesceDataRecv)
+        {
+          NotifyDataRecv ();
+        }
+      else if (!m_dataRecvEvent.IsRunning ())
+        {
+          // the packets received until the end of this event share the notification
+          m_dataRecvEvent = Simulator::ScheduleNow (&PacketSocket::NotifyCoalescedDataRecv, this);
+        }
     }
   else
     {
@@ -470,6 +488,31 @@ PacketSocket::RecvFrom (uint32_t maxSize, uint32_t flags, Address &fromAddress)
   return p;
 }
 
+uint32_t
+PacketSocket::RecvBatch (uint32_t maxPackets, std::vector<std::pair<Ptr<Packet>, Address> > &packets)
+{
+  NS_LOG_FUNCTION (this << maxPackets);
+  uint32_t n = 0;
+  while (n < maxPackets && !m_deliveryQueue.empty ())
+    {
+      packets.push_back (m_deliveryQueue.front ());
+      m_rxAvailable -= m_deliveryQueue.front ().first->GetSize ();
+      m_deliveryQueue.pop ();
+      n++;
+    }
+  return n;
+}
+
+void
+PacketSocket::NotifyCoalescedDataRecv (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_deliveryQueue.empty ())
+    {
+      NotifyDataRecv ();
+    }
+}
+
 int
 PacketSocket::GetSockName (Address &address) const
 {
@@ -23,7 +23,9 @@
 
 #include <stdint.h>
 #include <queue>
+#include <vector>
 #include "ns3/callback.h"
+#include "ns3/event-id.h"
 #include "ns3/traced-callback.h"
 #include "ns3/ptr.h"
 #include "ns3/socket.h"
@@ -152,7 +154,27 @@ public:
   virtual bool SetAllowBroadcast (bool allowBroadcast);
   virtual bool GetAllowBroadcast () const;
 
+  /**
+   * \brief Read several packets from the socket at once.
+   *
+   * Up to maxPackets packets are removed from the receive queue, in
+   * order, and appended to packets along with the address of their
+   * originator (as RecvFrom would return it).  A receive callback can
+   * drain the queue with a few calls instead of one call per packet.
+   *
+   * \param maxPackets the maximum number of packets to read
+   * \param packets the vector the packets and their addresses are appended to
+   * \returns the number of packets read, 0 if the queue is empty
+   */
+  uint32_t RecvBatch (uint32_t maxPackets, std::vector<std::pair<Ptr<Packet>, Address> > &packets);
+
 private:
+  /**
+   * \brief Notify the application of the packets received during the last event.
+   *
+   * Used when the "CoalesceDataRecv" attribute is set.
+   */
+  void NotifyCoalescedDataRecv (void);
   /**
    * \brief Called by the L3 protocol when it received a packet to pass on to TCP.
    *
@@ -204,6 +226,8 @@ private:
 
   std::queue<std::pair<Ptr<Packet>, Address> > m_deliveryQueue; //!< Rx queue
   uint32_t m_rxAvailable; //!< Rx queue size [Bytes]
+  bool m_coalesceDataRecv; //!< Notify received data once per event
+  EventId m_dataRecvEvent; //!< Pending coalesced notification
 
   /// Traced callback: dropped packets
   TracedCallback<Ptr<const Packet> > m_dropTrace;
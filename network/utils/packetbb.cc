@@ -22,10 +22,14 @@
  * (MANET) Packet/PbbMessage Format
  * See: http://tools.ietf.org/html/rfc5444 for details */
 
+#include <algorithm>
+#include <cstring>
+
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/fatal-error.h"
 #include "packetbb.h"
 
 static const uint8_t VERSION = 0;
@@ -3084,4 +3088,1256 @@ PbbAddressTlv::IsMultivalue (void) const
   return PbbTlv::IsMultivalue ();
 }
 
+PbbTlvIterator::PbbTlvIterator (void)
+  : m_remaining (0)
+{
+}
+
+PbbTlvIterator::PbbTlvIterator (Buffer::Iterator start, uint32_t size)
+  : m_current (start),
+    m_remaining (size)
+{
+}
+
+bool
+PbbTlvIterator::HasNext (void) const
+{
+  return m_remaining > 0;
+}
+
+PbbTlvView
+PbbTlvIterator::Next (void)
+{
+  NS_ASSERT (HasNext ());
+  PbbTlvView tlv;
+  tlv.Parse (m_current);
+  m_current.Next (tlv.GetSerializedSize ());
+  m_remaining -= std::min (m_remaining, tlv.GetSerializedSize ());
+  return tlv;
+}
+
+PbbTlvView::PbbTlvView (void)
+  : m_size (0),
+    m_valueSize (0),
+    m_type (0),
+    m_flags (0),
+    m_typeExt (0),
+    m_indexStart (0),
+    m_indexStop (0)
+{
+}
+
+void
+PbbTlvView::Parse (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_type = i.ReadU8 ();
+  m_flags = i.ReadU8 ();
+  if (m_flags & THAS_TYPE_EXT)
+    {
+      m_typeExt = i.ReadU8 ();
+    }
+  if (m_flags & THAS_MULTI_INDEX)
+    {
+      m_indexStart = i.ReadU8 ();
+      m_indexStop = i.ReadU8 ();
+    }
+  else if (m_flags & THAS_SINGLE_INDEX)
+    {
+      m_indexStart = i.ReadU8 ();
+    }
+  if (m_flags & THAS_VALUE)
+    {
+      if (m_flags & THAS_EXT_LEN)
+        {
+          m_valueSize = i.ReadNtohU16 ();
+        }
+      else
+        {
+          m_valueSize = i.ReadU8 ();
+        }
+    }
+  m_value = i;
+  i.Next (m_valueSize);
+  m_size = i.GetDistanceFrom (start);
+}
+
+uint8_t
+PbbTlvView::GetType (void) const
+{
+  return m_type;
+}
+
+bool
+PbbTlvView::HasTypeExt (void) const
+{
+  return m_flags & THAS_TYPE_EXT;
+}
+
+uint8_t
+PbbTlvView::GetTypeExt (void) const
+{
+  NS_ASSERT (HasTypeExt ());
+  return m_typeExt;
+}
+
+bool
+PbbTlvView::HasIndexStart (void) const
+{
+  return m_flags & (THAS_SINGLE_INDEX | THAS_MULTI_INDEX);
+}
+
+uint8_t
+PbbTlvView::GetIndexStart (void) const
+{
+  NS_ASSERT (HasIndexStart ());
+  return m_indexStart;
+}
+
+bool
+PbbTlvView::HasIndexStop (void) const
+{
+  return m_flags & THAS_MULTI_INDEX;
+}
+
+uint8_t
+PbbTlvView::GetIndexStop (void) const
+{
+  NS_ASSERT (HasIndexStop ());
+  return m_indexStop;
+}
+
+bool
+PbbTlvView::IsMultivalue (void) const
+{
+  return m_flags & TIS_MULTIVALUE;
+}
+
+bool
+PbbTlvView::HasValue (void) const
+{
+  return m_flags & THAS_VALUE;
+}
+
+uint16_t
+PbbTlvView::GetValueSize (void) const
+{
+  return m_valueSize;
+}
+
+Buffer::Iterator
+PbbTlvView::GetValue (void) const
+{
+  NS_ASSERT (HasValue ());
+  return m_value;
+}
+
+uint32_t
+PbbTlvView::GetSerializedSize (void) const
+{
+  return m_size;
+}
+
+/**
+ * \brief Build an address from its bytes.
+ * \param buffer the address bytes
+ * \param length the address length: 4 or 16
+ * \returns the address
+ */
+static Address
+PbbDeserializeAddress (uint8_t const *buffer, uint8_t length)
+{
+  if (length == 4)
+    {
+      return Ipv4Address::Deserialize (buffer);
+    }
+  return Ipv6Address::Deserialize (buffer);
+}
+
+PbbAddressIterator::PbbAddressIterator (void)
+  : m_addressLength (0),
+    m_headLength (0),
+    m_tailLength (0),
+    m_zeroTail (false),
+    m_remaining (0)
+{
+}
+
+bool
+PbbAddressIterator::HasNext (void) const
+{
+  return m_remaining > 0;
+}
+
+Address
+PbbAddressIterator::Next (void)
+{
+  NS_ASSERT (HasNext ());
+  uint8_t buffer[16];
+  memset (buffer, 0, sizeof (buffer));
+  Buffer::Iterator i = m_head;
+  i.Read (buffer, m_headLength);
+  if (!m_zeroTail)
+    {
+      i = m_tail;
+      i.Read (buffer + m_addressLength - m_tailLength, m_tailLength);
+    }
+  m_mid.Read (buffer + m_headLength, m_addressLength - m_headLength - m_tailLength);
+  m_remaining--;
+  return PbbDeserializeAddress (buffer, m_addressLength);
+}
+
+PbbAddressBlockView::PbbAddressBlockView (void)
+  : m_size (0),
+    m_tlvSize (0),
+    m_nPrefixes (0)
+{
+}
+
+void
+PbbAddressBlockView::Parse (Buffer::Iterator start, uint8_t addressLength)
+{
+  Buffer::Iterator i = start;
+  uint8_t numaddr = i.ReadU8 ();
+  uint8_t flags = i.ReadU8 ();
+  m_addresses = PbbAddressIterator ();
+  m_addresses.m_addressLength = addressLength;
+  m_addresses.m_remaining = numaddr;
+  m_nPrefixes = 0;
+
+  if (numaddr > 0)
+    {
+      if (flags & AHAS_HEAD)
+        {
+          m_addresses.m_headLength = i.ReadU8 ();
+          m_addresses.m_head = i;
+          i.Next (m_addresses.m_headLength);
+        }
+
+      if ((flags & AHAS_FULL_TAIL) ^ (flags & AHAS_ZERO_TAIL))
+        {
+          m_addresses.m_tailLength = i.ReadU8 ();
+          if (flags & AHAS_FULL_TAIL)
+            {
+              m_addresses.m_tail = i;
+              i.Next (m_addresses.m_tailLength);
+            }
+          else
+            {
+              m_addresses.m_zeroTail = true;
+            }
+        }
+
+      m_addresses.m_mid = i;
+      i.Next ((addressLength - m_addresses.m_headLength - m_addresses.m_tailLength) * numaddr);
+
+      m_prefixes = i;
+      if (flags & AHAS_SINGLE_PRE_LEN)
+        {
+          m_nPrefixes = 1;
+        }
+      else if (flags & AHAS_MULTI_PRE_LEN)
+        {
+          m_nPrefixes = numaddr;
+        }
+      i.Next (m_nPrefixes);
+    }
+
+  m_tlvSize = i.ReadNtohU16 ();
+  m_tlvs = i;
+  i.Next (m_tlvSize);
+  m_size = i.GetDistanceFrom (start);
+}
+
+uint8_t
+PbbAddressBlockView::GetNAddresses (void) const
+{
+  return m_addresses.m_remaining;
+}
+
+PbbAddressIterator
+PbbAddressBlockView::GetAddressIterator (void) const
+{
+  return m_addresses;
+}
+
+uint8_t
+PbbAddressBlockView::GetNPrefixes (void) const
+{
+  return m_nPrefixes;
+}
+
+uint8_t
+PbbAddressBlockView::GetPrefix (uint8_t index) const
+{
+  NS_ASSERT (index < m_nPrefixes);
+  Buffer::Iterator i = m_prefixes;
+  i.Next (index);
+  return i.ReadU8 ();
+}
+
+PbbTlvIterator
+PbbAddressBlockView::GetTlvIterator (void) const
+{
+  return PbbTlvIterator (m_tlvs, m_tlvSize);
+}
+
+uint32_t
+PbbAddressBlockView::GetSerializedSize (void) const
+{
+  return m_size;
+}
+
+PbbAddressBlockIterator::PbbAddressBlockIterator (void)
+  : m_remaining (0),
+    m_addressLength (0)
+{
+}
+
+bool
+PbbAddressBlockIterator::HasNext (void) const
+{
+  return m_remaining > 0;
+}
+
+PbbAddressBlockView
+PbbAddressBlockIterator::Next (void)
+{
+  NS_ASSERT (HasNext ());
+  PbbAddressBlockView block;
+  block.Parse (m_current, m_addressLength);
+  m_current.Next (block.GetSerializedSize ());
+  m_remaining -= std::min (m_remaining, block.GetSerializedSize ());
+  return block;
+}
+
+PbbMessageView::PbbMessageView (void)
+  : m_size (0),
+    m_blocksSize (0),
+    m_tlvSize (0),
+    m_seqnum (0),
+    m_type (0),
+    m_flags (0),
+    m_addressLength (0),
+    m_hopLimit (0),
+    m_hopCount (0)
+{
+}
+
+void
+PbbMessageView::Parse (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_type = i.ReadU8 ();
+  /* The last four bits of the flags are the address length. */
+  m_flags = i.ReadU8 ();
+  m_addressLength = GetAddressLength () + 1;
+  uint16_t size = i.ReadNtohU16 ();
+
+  if (m_flags & MHAS_ORIG)
+    {
+      m_originator = i;
+      i.Next (m_addressLength);
+    }
+  if (m_flags & MHAS_HOP_LIMIT)
+    {
+      m_hopLimit = i.ReadU8 ();
+    }
+  if (m_flags & MHAS_HOP_COUNT)
+    {
+      m_hopCount = i.ReadU8 ();
+    }
+  if (m_flags & MHAS_SEQ_NUM)
+    {
+      m_seqnum = i.ReadNtohU16 ();
+    }
+
+  m_tlvSize = i.ReadNtohU16 ();
+  m_tlvs = i;
+  i.Next (m_tlvSize);
+
+  m_addressBlocks = i;
+  uint32_t headerSize = i.GetDistanceFrom (start);
+  m_blocksSize = size > headerSize ? size - headerSize : 0;
+  m_size = headerSize + m_blocksSize;
+}
+
+uint8_t
+PbbMessageView::GetType (void) const
+{
+  return m_type;
+}
+
+PbbAddressLength
+PbbMessageView::GetAddressLength (void) const
+{
+  return (m_flags & 0xf) == IPV6 ? IPV6 : IPV4;
+}
+
+bool
+PbbMessageView::HasOriginatorAddress (void) const
+{
+  return m_flags & MHAS_ORIG;
+}
+
+Address
+PbbMessageView::GetOriginatorAddress (void) const
+{
+  NS_ASSERT (HasOriginatorAddress ());
+  uint8_t buffer[16];
+  Buffer::Iterator i = m_originator;
+  i.Read (buffer, m_addressLength);
+  return PbbDeserializeAddress (buffer, m_addressLength);
+}
+
+bool
+PbbMessageView::HasHopLimit (void) const
+{
+  return m_flags & MHAS_HOP_LIMIT;
+}
+
+uint8_t
+PbbMessageView::GetHopLimit (void) const
+{
+  NS_ASSERT (HasHopLimit ());
+  return m_hopLimit;
+}
+
+bool
+PbbMessageView::HasHopCount (void) const
+{
+  return m_flags & MHAS_HOP_COUNT;
+}
+
+uint8_t
+PbbMessageView::GetHopCount (void) const
+{
+  NS_ASSERT (HasHopCount ());
+  return m_hopCount;
+}
+
+bool
+PbbMessageView::HasSequenceNumber (void) const
+{
+  return m_flags & MHAS_SEQ_NUM;
+}
+
+uint16_t
+PbbMessageView::GetSequenceNumber (void) const
+{
+  NS_ASSERT (HasSequenceNumber ());
+  return m_seqnum;
+}
+
+PbbTlvIterator
+PbbMessageView::GetTlvIterator (void) const
+{
+  return PbbTlvIterator (m_tlvs, m_tlvSize);
+}
+
+PbbAddressBlockIterator
+PbbMessageView::GetAddressBlockIterator (void) const
+{
+  PbbAddressBlockIterator iterator;
+  iterator.m_current = m_addressBlocks;
+  iterator.m_remaining = m_blocksSize;
+  iterator.m_addressLength = m_addressLength;
+  return iterator;
+}
+
+uint32_t
+PbbMessageView::GetSerializedSize (void) const
+{
+  return m_size;
+}
+
+PbbMessageIterator::PbbMessageIterator (void)
+  : m_remaining (0)
+{
+}
+
+bool
+PbbMessageIterator::HasNext (void) const
+{
+  return m_remaining > 0;
+}
+
+PbbMessageView
+PbbMessageIterator::Next (void)
+{
+  NS_ASSERT (HasNext ());
+  PbbMessageView message;
+  message.Parse (m_current);
+  m_current.Next (message.GetSerializedSize ());
+  m_remaining -= std::min (m_remaining, message.GetSerializedSize ());
+  return message;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PbbPacketView);
+
+PbbPacketView::PbbPacketView (void)
+  : m_size (0),
+    m_messagesSize (0),
+    m_tlvSize (0),
+    m_seqnum (0),
+    m_flags (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint8_t
+PbbPacketView::GetVersion (void) const
+{
+  return m_flags >> 4;
+}
+
+bool
+PbbPacketView::HasSequenceNumber (void) const
+{
+  return m_flags & PHAS_SEQ_NUM;
+}
+
+uint16_t
+PbbPacketView::GetSequenceNumber (void) const
+{
+  NS_ASSERT (HasSequenceNumber ());
+  return m_seqnum;
+}
+
+PbbTlvIterator
+PbbPacketView::GetTlvIterator (void) const
+{
+  return PbbTlvIterator (m_tlvs, m_tlvSize);
+}
+
+PbbMessageIterator
+PbbPacketView::GetMessageIterator (void) const
+{
+  PbbMessageIterator iterator;
+  iterator.m_current = m_messages;
+  iterator.m_remaining = m_messagesSize;
+  return iterator;
+}
+
+TypeId
+PbbPacketView::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PbbPacketView")
+    .SetParent<Header> ()
+    .SetGroupName("Network")
+    .AddConstructor<PbbPacketView> ()
+  ;
+  return tid;
+}
+
+TypeId
+PbbPacketView::GetInstanceTypeId (void) const
+{
+  return PbbPacket::GetTypeId ();
+}
+
+uint32_t
+PbbPacketView::GetSerializedSize (void) const
+{
+  return m_size;
+}
+
+void
+PbbPacketView::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator end = m_start;
+  end.Next (m_size);
+  start.Write (m_start, end);
+}
+
+uint32_t
+PbbPacketView::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  m_start = start;
+  m_flags = start.ReadU8 ();
+
+  if (m_flags & PHAS_SEQ_NUM)
+    {
+      m_seqnum = start.ReadNtohU16 ();
+    }
+
+  m_tlvSize = 0;
+  if (m_flags & PHAS_TLV)
+    {
+      m_tlvSize = start.ReadNtohU16 ();
+      m_tlvs = start;
+      start.Next (m_tlvSize);
+    }
+
+  /* Only the message headers are decoded, to skip from one to the next. */
+  m_messages = start;
+  while (!start.IsEnd ())
+    {
+      Buffer::Iterator addrlen = start;
+      addrlen.Next ();
+      switch (addrlen.ReadU8 () & 0xf)
+        {
+        case 0:
+        case IPV4:
+        case IPV6:
+          break;
+        default:
+          m_messagesSize = start.GetDistanceFrom (m_messages);
+          m_size = start.GetDistanceFrom (m_start);
+          return m_size;
+        }
+      PbbMessageView message;
+      message.Parse (start);
+      start.Next (message.GetSerializedSize ());
+    }
+
+  m_messagesSize = start.GetDistanceFrom (m_messages);
+  m_size = start.GetDistanceFrom (m_start);
+  return m_size;
+}
+
+void
+PbbPacketView::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "PbbPacketView {" << std::endl;
+  if (HasSequenceNumber ())
+    {
+      os << "\tsequence number = " << GetSequenceNumber () << std::endl;
+    }
+  PbbMessageIterator i = GetMessageIterator ();
+  while (i.HasNext ())
+    {
+      PbbMessageView message = i.Next ();
+      os << "\tmessage type = " << (int)message.GetType ()
+         << " size = " << message.GetSerializedSize () << std::endl;
+    }
+  os << "}" << std::endl;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PbbPacketBuilder);
+
+PbbPacketBuilder::PbbPacketBuilder (void)
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+PbbPacketBuilder::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tlvs.clear ();
+  m_blocks.clear ();
+  m_messages.clear ();
+  m_addresses.clear ();
+  m_prefixes.clear ();
+  m_values.clear ();
+  m_packetTlvs.start = 0;
+  m_packetTlvs.count = 0;
+  m_scope = PACKET;
+  m_hasseqnum = false;
+  m_seqnum = 0;
+}
+
+void
+PbbPacketBuilder::SetSequenceNumber (uint16_t number)
+{
+  NS_LOG_FUNCTION (this << number);
+  m_seqnum = number;
+  m_hasseqnum = true;
+}
+
+void
+PbbPacketBuilder::AddMessage (uint8_t type, PbbAddressLength addressLength)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (type) << addressLength);
+  Message message;
+  message.tlvs.start = m_tlvs.size ();
+  message.tlvs.count = 0;
+  message.blockStart = m_blocks.size ();
+  message.blockCount = 0;
+  message.seqnum = 0;
+  message.type = type;
+  message.flags = addressLength;
+  message.hopLimit = 0;
+  message.hopCount = 0;
+  m_messages.push_back (message);
+  m_scope = MESSAGE;
+}
+
+void
+PbbPacketBuilder::SetOriginatorAddress (Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  NS_ASSERT (!m_messages.empty ());
+  Message &message = m_messages.back ();
+  if ((message.flags & 0xf) == IPV6)
+    {
+      Ipv6Address::ConvertFrom (address).Serialize (message.originator);
+    }
+  else
+    {
+      Ipv4Address::ConvertFrom (address).Serialize (message.originator);
+    }
+  message.flags |= MHAS_ORIG;
+}
+
+void
+PbbPacketBuilder::SetHopLimit (uint8_t hoplimit)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (hoplimit));
+  NS_ASSERT (!m_messages.empty ());
+  m_messages.back ().hopLimit = hoplimit;
+  m_messages.back ().flags |= MHAS_HOP_LIMIT;
+}
+
+void
+PbbPacketBuilder::SetHopCount (uint8_t hopcount)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (hopcount));
+  NS_ASSERT (!m_messages.empty ());
+  m_messages.back ().hopCount = hopcount;
+  m_messages.back ().flags |= MHAS_HOP_COUNT;
+}
+
+void
+PbbPacketBuilder::SetMessageSequenceNumber (uint16_t number)
+{
+  NS_LOG_FUNCTION (this << number);
+  NS_ASSERT (!m_messages.empty ());
+  m_messages.back ().seqnum = number;
+  m_messages.back ().flags |= MHAS_SEQ_NUM;
+}
+
+uint32_t
+PbbPacketBuilder::GetNMessages (void) const
+{
+  return m_messages.size ();
+}
+
+void
+PbbPacketBuilder::AddAddressBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_messages.empty ());
+  Message &message = m_messages.back ();
+  AddressBlock block;
+  block.tlvs.start = m_tlvs.size ();
+  block.tlvs.count = 0;
+  block.addressStart = m_addresses.size ();
+  block.prefixStart = m_prefixes.size ();
+  block.addressCount = 0;
+  block.prefixCount = 0;
+  block.addressLength = (message.flags & 0xf) == IPV6 ? 16 : 4;
+  block.compressed = false;
+  block.zeroTail = false;
+  block.headLength = 0;
+  block.tailLength = 0;
+  m_blocks.push_back (block);
+  message.blockCount++;
+  m_scope = ADDRESS_BLOCK;
+}
+
+void
+PbbPacketBuilder::AddAddress (Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  NS_ASSERT (m_scope == ADDRESS_BLOCK);
+  AddressBlock &block = m_blocks.back ();
+  NS_ASSERT (block.addressCount < 255);
+  uint8_t buffer[16];
+  if (block.addressLength == 16)
+    {
+      Ipv6Address::ConvertFrom (address).Serialize (buffer);
+    }
+  else
+    {
+      Ipv4Address::ConvertFrom (address).Serialize (buffer);
+    }
+  m_addresses.insert (m_addresses.end (), buffer, buffer + block.addressLength);
+  block.addressCount++;
+  block.compressed = false;
+}
+
+void
+PbbPacketBuilder::AddPrefix (uint8_t prefix)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (prefix));
+  NS_ASSERT (m_scope == ADDRESS_BLOCK);
+  m_prefixes.push_back (prefix);
+  m_blocks.back ().prefixCount++;
+}
+
+void
+PbbPacketBuilder::AddTlv (uint8_t type)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (type));
+  Tlv tlv;
+  tlv.valueStart = 0;
+  tlv.valueSize = 0;
+  tlv.type = type;
+  tlv.typeExt = 0;
+  tlv.indexStart = 0;
+  tlv.indexStop = 0;
+  tlv.flags = 0;
+  m_tlvs.push_back (tlv);
+  switch (m_scope)
+    {
+    case PACKET:
+      m_packetTlvs.count++;
+      break;
+    case MESSAGE:
+      m_messages.back ().tlvs.count++;
+      break;
+    case ADDRESS_BLOCK:
+      m_blocks.back ().tlvs.count++;
+      break;
+    }
+}
+
+PbbPacketBuilder::Tlv &
+PbbPacketBuilder::GetLastTlv (void)
+{
+  NS_ASSERT (!m_tlvs.empty ());
+  return m_tlvs.back ();
+}
+
+void
+PbbPacketBuilder::SetTlvTypeExt (uint8_t type)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (type));
+  Tlv &tlv = GetLastTlv ();
+  tlv.typeExt = type;
+  tlv.flags |= THAS_TYPE_EXT;
+}
+
+void
+PbbPacketBuilder::SetTlvValue (const uint8_t *value, uint16_t size)
+{
+  NS_LOG_FUNCTION (this << &value << size);
+  Tlv &tlv = GetLastTlv ();
+  tlv.valueStart = m_values.size ();
+  tlv.valueSize = size;
+  tlv.flags |= THAS_VALUE;
+  m_values.insert (m_values.end (), value, value + size);
+}
+
+void
+PbbPacketBuilder::SetTlvIndexStart (uint8_t index)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (index));
+  Tlv &tlv = GetLastTlv ();
+  tlv.indexStart = index;
+  if (!(tlv.flags & THAS_MULTI_INDEX))
+    {
+      tlv.flags |= THAS_SINGLE_INDEX;
+    }
+}
+
+void
+PbbPacketBuilder::SetTlvIndexStop (uint8_t index)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (index));
+  Tlv &tlv = GetLastTlv ();
+  NS_ASSERT (tlv.flags & (THAS_SINGLE_INDEX | THAS_MULTI_INDEX));
+  tlv.indexStop = index;
+  tlv.flags &= ~THAS_SINGLE_INDEX;
+  tlv.flags |= THAS_MULTI_INDEX;
+}
+
+void
+PbbPacketBuilder::SetTlvMultivalue (bool isMultivalue)
+{
+  NS_LOG_FUNCTION (this << isMultivalue);
+  Tlv &tlv = GetLastTlv ();
+  if (isMultivalue)
+    {
+      tlv.flags |= TIS_MULTIVALUE;
+    }
+  else
+    {
+      tlv.flags &= ~TIS_MULTIVALUE;
+    }
+}
+
+void
+PbbPacketBuilder::Compress (const AddressBlock &block) const
+{
+  if (block.compressed)
+    {
+      return;
+    }
+  uint8_t length = block.addressLength;
+  const uint8_t *first = &m_addresses[block.addressStart];
+  uint8_t headlen = length;
+  uint8_t taillen = length;
+  for (uint16_t a = 1; a < block.addressCount; a++)
+    {
+      const uint8_t *cur = first + a * length;
+      for (uint8_t i = 0; i < headlen; i++)
+        {
+          if (first[i] != cur[i])
+            {
+              headlen = i;
+              break;
+            }
+        }
+      for (uint8_t i = 0; i < taillen; i++)
+        {
+          if (first[length - 1 - i] != cur[length - 1 - i])
+            {
+              taillen = i;
+              break;
+            }
+        }
+    }
+  /* Identical addresses: the head covers them. */
+  taillen = std::min<uint8_t> (taillen, length - headlen);
+
+  bool zeroTail = true;
+  for (uint8_t i = length - taillen; i < length; i++)
+    {
+      zeroTail = zeroTail && first[i] == 0;
+    }
+
+  block.headLength = headlen;
+  block.tailLength = taillen;
+  block.zeroTail = zeroTail;
+  block.compressed = true;
+}
+
+uint32_t
+PbbPacketBuilder::GetTlvBlockSize (const TlvRange &tlvs) const
+{
+  /* tlv size */
+  uint32_t size = 2;
+  for (uint32_t i = tlvs.start; i < tlvs.start + tlvs.count; i++)
+    {
+      const Tlv &tlv = m_tlvs[i];
+      /* type + flags */
+      size += 2;
+      if (tlv.flags & THAS_TYPE_EXT)
+        {
+          size++;
+        }
+      if (tlv.flags & THAS_SINGLE_INDEX)
+        {
+          size++;
+        }
+      if (tlv.flags & THAS_MULTI_INDEX)
+        {
+          size += 2;
+        }
+      if (tlv.flags & THAS_VALUE)
+        {
+          size += (tlv.valueSize > 255 ? 2 : 1) + tlv.valueSize;
+        }
+    }
+  return size;
+}
+
+uint32_t
+PbbPacketBuilder::GetAddressBlockSize (const AddressBlock &block) const
+{
+  /* num-addr + flags */
+  uint32_t size = 2;
+
+  if (block.addressCount == 1)
+    {
+      size += block.addressLength + (block.prefixCount == 1 ? 1 : 0);
+    }
+  else if (block.addressCount > 0)
+    {
+      Compress (block);
+      if (block.headLength > 0)
+        {
+          size += 1 + block.headLength;
+        }
+      if (block.tailLength > 0)
+        {
+          size += 1 + (block.zeroTail ? 0 : block.tailLength);
+        }
+      /* mid size */
+      size += (block.addressLength - block.headLength - block.tailLength) * block.addressCount;
+      size += block.prefixCount;
+    }
+
+  size += GetTlvBlockSize (block.tlvs);
+  return size;
+}
+
+uint32_t
+PbbPacketBuilder::GetMessageSize (const Message &message) const
+{
+  /* msg-type + (msg-flags + msg-addr-length) + 2msg-size */
+  uint32_t size = 4;
+  if (message.flags & MHAS_ORIG)
+    {
+      size += (message.flags & 0xf) + 1;
+    }
+  if (message.flags & MHAS_HOP_LIMIT)
+    {
+      size++;
+    }
+  if (message.flags & MHAS_HOP_COUNT)
+    {
+      size++;
+    }
+  if (message.flags & MHAS_SEQ_NUM)
+    {
+      size += 2;
+    }
+  size += GetTlvBlockSize (message.tlvs);
+  for (uint32_t i = message.blockStart; i < message.blockStart + message.blockCount; i++)
+    {
+      size += GetAddressBlockSize (m_blocks[i]);
+    }
+  return size;
+}
+
+TypeId
+PbbPacketBuilder::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PbbPacketBuilder")
+    .SetParent<Header> ()
+    .SetGroupName("Network")
+    .AddConstructor<PbbPacketBuilder> ()
+  ;
+  return tid;
+}
+
+TypeId
+PbbPacketBuilder::GetInstanceTypeId (void) const
+{
+  return PbbPacket::GetTypeId ();
+}
+
+uint32_t
+PbbPacketBuilder::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  /* Version number + flags */
+  uint32_t size = 1;
+  if (m_hasseqnum)
+    {
+      size += 2;
+    }
+  if (m_packetTlvs.count > 0)
+    {
+      size += GetTlvBlockSize (m_packetTlvs);
+    }
+  for (std::vector<Message>::const_iterator iter = m_messages.begin ();
+       iter != m_messages.end ();
+       iter++)
+    {
+      size += GetMessageSize (*iter);
+    }
+  return size;
+}
+
+void
+PbbPacketBuilder::SerializeTlvBlock (Buffer::Iterator &start, const TlvRange &tlvs) const
+{
+  start.WriteHtonU16 (GetTlvBlockSize (tlvs) - 2);
+  for (uint32_t i = tlvs.start; i < tlvs.start + tlvs.count; i++)
+    {
+      const Tlv &tlv = m_tlvs[i];
+      uint8_t flags = tlv.flags;
+      if (!(flags & THAS_VALUE))
+        {
+          flags &= ~TIS_MULTIVALUE;
+        }
+      else if (tlv.valueSize > 255)
+        {
+          flags |= THAS_EXT_LEN;
+        }
+      start.WriteU8 (tlv.type);
+      start.WriteU8 (flags);
+      if (flags & THAS_TYPE_EXT)
+        {
+          start.WriteU8 (tlv.typeExt);
+        }
+      if (flags & (THAS_SINGLE_INDEX | THAS_MULTI_INDEX))
+        {
+          start.WriteU8 (tlv.indexStart);
+        }
+      if (flags & THAS_MULTI_INDEX)
+        {
+          start.WriteU8 (tlv.indexStop);
+        }
+      if (flags & THAS_VALUE)
+        {
+          if (flags & THAS_EXT_LEN)
+            {
+              start.WriteHtonU16 (tlv.valueSize);
+            }
+          else
+            {
+              start.WriteU8 (tlv.valueSize);
+            }
+          if (tlv.valueSize > 0)
+            {
+              start.Write (&m_values[tlv.valueStart], tlv.valueSize);
+            }
+        }
+    }
+}
+
+void
+PbbPacketBuilder::SerializeAddressBlock (Buffer::Iterator &start, const AddressBlock &block) const
+{
+  start.WriteU8 (block.addressCount);
+  const uint8_t *addresses = block.addressCount > 0 ? &m_addresses[block.addressStart] : 0;
+
+  if (block.addressCount == 1)
+    {
+      start.WriteU8 (block.prefixCount == 1 ? AHAS_SINGLE_PRE_LEN : 0);
+      start.Write (addresses, block.addressLength);
+      if (block.prefixCount == 1)
+        {
+          start.WriteU8 (m_prefixes[block.prefixStart]);
+        }
+    }
+  else if (block.addressCount > 0)
+    {
+      Compress (block);
+      uint8_t flags = 0;
+      if (block.headLength > 0)
+        {
+          flags |= AHAS_HEAD;
+        }
+      if (block.tailLength > 0)
+        {
+          flags |= block.zeroTail ? AHAS_ZERO_TAIL : AHAS_FULL_TAIL;
+        }
+      if (block.prefixCount == 1)
+        {
+          flags |= AHAS_SINGLE_PRE_LEN;
+        }
+      else if (block.prefixCount > 1)
+        {
+          flags |= AHAS_MULTI_PRE_LEN;
+        }
+      start.WriteU8 (flags);
+
+      if (block.headLength > 0)
+        {
+          start.WriteU8 (block.headLength);
+          start.Write (addresses, block.headLength);
+        }
+      if (block.tailLength > 0)
+        {
+          start.WriteU8 (block.tailLength);
+          if (!block.zeroTail)
+            {
+              start.Write (addresses + block.addressLength - block.tailLength, block.tailLength);
+            }
+        }
+      uint8_t midlen = block.addressLength - block.headLength - block.tailLength;
+      if (midlen > 0)
+        {
+          for (uint16_t i = 0; i < block.addressCount; i++)
+            {
+              start.Write (addresses + i * block.addressLength + block.headLength, midlen);
+            }
+        }
+      if (block.prefixCount > 0)
+        {
+          start.Write (&m_prefixes[block.prefixStart], block.prefixCount);
+        }
+    }
+  else
+    {
+      start.WriteU8 (0);
+    }
+
+  SerializeTlvBlock (start, block.tlvs);
+}
+
+void
+PbbPacketBuilder::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  uint8_t flags = VERSION << 4;
+  if (m_hasseqnum)
+    {
+      flags |= PHAS_SEQ_NUM;
+    }
+  if (m_packetTlvs.count > 0)
+    {
+      flags |= PHAS_TLV;
+    }
+  start.WriteU8 (flags);
+  if (m_hasseqnum)
+    {
+      start.WriteHtonU16 (m_seqnum);
+    }
+  if (m_packetTlvs.count > 0)
+    {
+      SerializeTlvBlock (start, m_packetTlvs);
+    }
+
+  for (std::vector<Message>::const_iterator iter = m_messages.begin ();
+       iter != m_messages.end ();
+       iter++)
+    {
+      const Message &message = *iter;
+      start.WriteU8 (message.type);
+      start.WriteU8 (message.flags);
+      start.WriteHtonU16 (GetMessageSize (message));
+      if (message.flags & MHAS_ORIG)
+        {
+          start.Write (message.originator, (message.flags & 0xf) + 1);
+        }
+      if (message.flags & MHAS_HOP_LIMIT)
+        {
+          start.WriteU8 (message.hopLimit);
+        }
+      if (message.flags & MHAS_HOP_COUNT)
+        {
+          start.WriteU8 (message.hopCount);
+        }
+      if (message.flags & MHAS_SEQ_NUM)
+        {
+          start.WriteHtonU16 (message.seqnum);
+        }
+      SerializeTlvBlock (start, message.tlvs);
+      for (uint32_t i = message.blockStart; i < message.blockStart + message.blockCount; i++)
+        {
+          SerializeAddressBlock (start, m_blocks[i]);
+        }
+    }
+}
+
+uint32_t
+PbbPacketBuilder::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  NS_FATAL_ERROR ("PbbPacketBuilder only builds packets: use PbbPacket or PbbPacketView to read them");
+  return 0;
+}
+
+void
+PbbPacketBuilder::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "PbbPacketBuilder {" << std::endl;
+  if (m_hasseqnum)
+    {
+      os << "\tsequence number = " << m_seqnum << std::endl;
+    }
+  os << "\tpacket TLVs = " << m_packetTlvs.count << std::endl;
+  for (std::vector<Message>::const_iterator iter = m_messages.begin ();
+       iter != m_messages.end ();
+       iter++)
+    {
+      os << "\tmessage type = " << (int)iter->type
+         << " address blocks = " << iter->blockCount << std::endl;
+    }
+  os << "}" << std::endl;
+}
+
 } /* namespace ns3 */
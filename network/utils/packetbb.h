@@ -26,6 +26,7 @@
 #define PACKETBB_H
 
 #include <list>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/address.h"
@@ -1922,6 +1923,686 @@ public:
   bool IsMultivalue (void) const;
 };
 
+class PbbTlvView;
+class PbbMessageView;
+class PbbAddressBlockView;
+
+/**
+ * \brief Iterator over the TLVs of a TLV block in a serialized PacketBB packet.
+ *
+ * The TLVs are decoded one at a time, when Next is called, directly from
+ * the buffer of the packet.  Works for packet, message and address TLVs.
+ */
+class PbbTlvIterator
+{
+public:
+  PbbTlvIterator (void);
+  /**
+   * \returns true if Next can be called, false otherwise.
+   */
+  bool HasNext (void) const;
+  /**
+   * \returns the next TLV.
+   */
+  PbbTlvView Next (void);
+private:
+  friend class PbbPacketView;
+  friend class PbbMessageView;
+  friend class PbbAddressBlockView;
+  /**
+   * \param start the first TLV of the block
+   * \param size the size of the TLVs of the block
+   */
+  PbbTlvIterator (Buffer::Iterator start, uint32_t size);
+
+  Buffer::Iterator m_current; //!< the next TLV
+  uint32_t m_remaining; //!< the size of the remaining TLVs
+};
+
+/**
+ * \brief Read-only view of a TLV in a serialized PacketBB packet.
+ *
+ * The accessors match those of PbbTlv and PbbAddressTlv.
+ */
+class PbbTlvView
+{
+public:
+  PbbTlvView (void);
+  /**
+   * \return the type of this TLV.
+   */
+  uint8_t GetType (void) const;
+  /**
+   * \return true if this TLV has a type extension, false otherwise.
+   */
+  bool HasTypeExt (void) const;
+  /**
+   * \return the type extension of this TLV.
+   *
+   * Calling this while HasTypeExt is False is undefined.
+   */
+  uint8_t GetTypeExt (void) const;
+  /**
+   * \return true if this TLV has a start index, false otherwise.
+   */
+  bool HasIndexStart (void) const;
+  /**
+   * \return the start index of this TLV.
+   *
+   * Calling this while HasIndexStart is False is undefined.
+   */
+  uint8_t GetIndexStart (void) const;
+  /**
+   * \return true if this TLV has a stop index, false otherwise.
+   */
+  bool HasIndexStop (void) const;
+  /**
+   * \return the stop index of this TLV.
+   *
+   * Calling this while HasIndexStop is False is undefined.
+   */
+  uint8_t GetIndexStop (void) const;
+  /**
+   * \return true if this address TLV is multivalue, false otherwise.
+   */
+  bool IsMultivalue (void) const;
+  /**
+   * \return true if this TLV has a value, false otherwise.
+   */
+  bool HasValue (void) const;
+  /**
+   * \return the size of the value of this TLV.
+   */
+  uint16_t GetValueSize (void) const;
+  /**
+   * \return an iterator to the first byte of the value of this TLV, in the
+   *         buffer of the packet.
+   *
+   * Calling this while HasValue is False is undefined.
+   */
+  Buffer::Iterator GetValue (void) const;
+  /**
+   * \return the size of this TLV in the packet.
+   */
+  uint32_t GetSerializedSize (void) const;
+private:
+  friend class PbbTlvIterator;
+  /**
+   * \brief Decode the TLV header.
+   * \param start the start of the TLV
+   */
+  void Parse (Buffer::Iterator start);
+
+  Buffer::Iterator m_value; //!< the value of the TLV
+  uint32_t m_size; //!< the size of the TLV
+  uint16_t m_valueSize; //!< the size of the value
+  uint8_t m_type; //!< the type
+  uint8_t m_flags; //!< the TLV flags
+  uint8_t m_typeExt; //!< the type extension
+  uint8_t m_indexStart; //!< the start index
+  uint8_t m_indexStop; //!< the stop index
+};
+
+/**
+ * \brief Iterator over the addresses of an address block in a serialized
+ * PacketBB packet.
+ *
+ * Each address is rebuilt from the compressed head, middle and tail
+ * of the block when Next is called.
+ */
+class PbbAddressIterator
+{
+public:
+  PbbAddressIterator (void);
+  /**
+   * \returns true if Next can be called, false otherwise.
+   */
+  bool HasNext (void) const;
+  /**
+   * \returns the next address.
+   */
+  Address Next (void);
+private:
+  friend class PbbAddressBlockView;
+
+  Buffer::Iterator m_head; //!< the head shared by the addresses
+  Buffer::Iterator m_tail; //!< the tail shared by the addresses
+  Buffer::Iterator m_mid; //!< the middle of the next address
+  uint8_t m_addressLength; //!< the size of the addresses: 4 or 16
+  uint8_t m_headLength; //!< the size of the head
+  uint8_t m_tailLength; //!< the size of the tail
+  bool m_zeroTail; //!< true if the tail is made of zeroes
+  uint8_t m_remaining; //!< the number of remaining addresses
+};
+
+/**
+ * \brief Read-only view of an address block in a serialized PacketBB packet.
+ */
+class PbbAddressBlockView
+{
+public:
+  PbbAddressBlockView (void);
+  /**
+   * \return the number of addresses in this block.
+   */
+  uint8_t GetNAddresses (void) const;
+  /**
+   * \return an iterator over the addresses of this block.
+   */
+  PbbAddressIterator GetAddressIterator (void) const;
+  /**
+   * \return the number of prefixes in this block: 0, 1 or the number of
+   *         addresses.
+   */
+  uint8_t GetNPrefixes (void) const;
+  /**
+   * \param index the index of the prefix
+   * \return the prefix length
+   */
+  uint8_t GetPrefix (uint8_t index) const;
+  /**
+   * \return an iterator over the address TLVs of this block.
+   */
+  PbbTlvIterator GetTlvIterator (void) const;
+  /**
+   * \return the size of this block in the packet.
+   */
+  uint32_t GetSerializedSize (void) const;
+private:
+  friend class PbbAddressBlockIterator;
+  /**
+   * \brief Decode the block header.
+   * \param start the start of the block
+   * \param addressLength the size of the addresses
+   */
+  void Parse (Buffer::Iterator start, uint8_t addressLength);
+
+  PbbAddressIterator m_addresses; //!< the addresses
+  Buffer::Iterator m_prefixes; //!< the prefixes
+  Buffer::Iterator m_tlvs; //!< the address TLVs
+  uint32_t m_size; //!< the size of the block
+  uint16_t m_tlvSize; //!< the size of the address TLVs
+  uint8_t m_nPrefixes; //!< the number of prefixes
+};
+
+/**
+ * \brief Iterator over the address blocks of a message in a serialized
+ * PacketBB packet.
+ */
+class PbbAddressBlockIterator
+{
+public:
+  PbbAddressBlockIterator (void);
+  /**
+   * \returns true if Next can be called, false otherwise.
+   */
+  bool HasNext (void) const;
+  /**
+   * \returns the next address block.
+   */
+  PbbAddressBlockView Next (void);
+private:
+  friend class PbbMessageView;
+
+  Buffer::Iterator m_current; //!< the next block
+  uint32_t m_remaining; //!< the size of the remaining blocks
+  uint8_t m_addressLength; //!< the size of the addresses
+};
+
+/**
+ * \brief Read-only view of a message in a serialized PacketBB packet.
+ */
+class PbbMessageView
+{
+public:
+  PbbMessageView (void);
+  /**
+   * \return the type of this message.
+   */
+  uint8_t GetType (void) const;
+  /**
+   * \return the address length of this message (IPV4 3 or IPV6 15).
+   */
+  PbbAddressLength GetAddressLength (void) const;
+  /**
+   * \return true if this message has an originator address, false otherwise.
+   */
+  bool HasOriginatorAddress (void) const;
+  /**
+   * \return the originator address of this message.
+   *
+   * Calling this while HasOriginatorAddress is False is undefined.
+   */
+  Address GetOriginatorAddress (void) const;
+  /**
+   * \return true if this message has a hop limit, false otherwise.
+   */
+  bool HasHopLimit (void) const;
+  /**
+   * \return the hop limit of this message.
+   */
+  uint8_t GetHopLimit (void) const;
+  /**
+   * \return true if this message has a hop count, false otherwise.
+   */
+  bool HasHopCount (void) const;
+  /**
+   * \return the hop count of this message.
+   */
+  uint8_t GetHopCount (void) const;
+  /**
+   * \return true if this message has a sequence number, false otherwise.
+   */
+  bool HasSequenceNumber (void) const;
+  /**
+   * \return the sequence number of this message.
+   */
+  uint16_t GetSequenceNumber (void) const;
+  /**
+   * \return an iterator over the message TLVs of this message.
+   */
+  PbbTlvIterator GetTlvIterator (void) const;
+  /**
+   * \return an iterator over the address blocks of this message.
+   */
+  PbbAddressBlockIterator GetAddressBlockIterator (void) const;
+  /**
+   * \return the size of this message in the packet.
+   */
+  uint32_t GetSerializedSize (void) const;
+private:
+  friend class PbbMessageIterator;
+  friend class PbbPacketView;
+  /**
+   * \brief Decode the message header.
+   * \param start the start of the message
+   */
+  void Parse (Buffer::Iterator start);
+
+  Buffer::Iterator m_originator; //!< the originator address
+  Buffer::Iterator m_tlvs; //!< the message TLVs
+  Buffer::Iterator m_addressBlocks; //!< the address blocks
+  uint32_t m_size; //!< the size of the message
+  uint32_t m_blocksSize; //!< the size of the address blocks
+  uint16_t m_tlvSize; //!< the size of the message TLVs
+  uint16_t m_seqnum; //!< the sequence number
+  uint8_t m_type; //!< the type
+  uint8_t m_flags; //!< the message flags
+  uint8_t m_addressLength; //!< the size of the addresses: 4 or 16
+  uint8_t m_hopLimit; //!< the hop limit
+  uint8_t m_hopCount; //!< the hop count
+};
+
+/**
+ * \brief Iterator over the messages of a serialized PacketBB packet.
+ */
+class PbbMessageIterator
+{
+public:
+  PbbMessageIterator (void);
+  /**
+   * \returns true if Next can be called, false otherwise.
+   */
+  bool HasNext (void) const;
+  /**
+   * \returns the next message.
+   */
+  PbbMessageView Next (void);
+private:
+  friend class PbbPacketView;
+
+  Buffer::Iterator m_current; //!< the next message
+  uint32_t m_remaining; //!< the size of the remaining messages
+};
+
+/**
+ * \brief Read-only view of a serialized PacketBB packet.
+ *
+ * Unlike PbbPacket, which copies every message, address block, TLV and
+ * address into objects of their own, this header only records where the
+ * packet starts in the buffer it is deserialized from.  Messages, TLVs
+ * and addresses are then decoded lazily, one at a time, by iterators
+ * which walk the \RFC{5444} encoding in place and never allocate:
+ *
+ * \code
+ *   PbbPacketView view;
+ *   packet->PeekHeader (view);
+ *   PbbMessageIterator i = view.GetMessageIterator ();
+ *   while (i.HasNext ())
+ *     {
+ *       PbbMessageView message = i.Next ();
+ *       ...
+ *     }
+ * \endcode
+ *
+ * The view, and everything obtained from it, refers to the bytes of the
+ * packet it was deserialized from: it must not be used once that
+ * packet has been modified or destroyed.  Serializing the view copies
+ * the encoded packet as is.
+ */
+class PbbPacketView : public Header
+{
+public:
+  PbbPacketView (void);
+
+  /**
+   * \return the version of PacketBB that constructed this packet.
+   */
+  uint8_t GetVersion (void) const;
+  /**
+   * \return true if this packet has a sequence number, false otherwise.
+   */
+  bool HasSequenceNumber (void) const;
+  /**
+   * \return the sequence number of this packet.
+   *
+   * Calling this while HasSequenceNumber is False is undefined.
+   */
+  uint16_t GetSequenceNumber (void) const;
+  /**
+   * \return an iterator over the packet TLVs of this packet.
+   */
+  PbbTlvIterator GetTlvIterator (void) const;
+  /**
+   * \return an iterator over the messages of this packet.
+   */
+  PbbMessageIterator GetMessageIterator (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \return the TypeId of PbbPacket
+   *
+   * The view reads and writes the bytes of a PbbPacket, so the packet
+   * metadata records it as one: a packet can be read with either
+   * header whichever was used to write it.
+   */
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  /**
+   * \brief Records where the packet starts and finds where it ends.
+   * \param start start offset
+   * \return the number of bytes of the packet
+   *
+   * As with PbbPacket, the packet ends at the end of the buffer, or at
+   * the first message with an unknown address length.
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  Buffer::Iterator m_start; //!< the start of the packet
+  Buffer::Iterator m_tlvs; //!< the packet TLVs
+  Buffer::Iterator m_messages; //!< the messages
+  uint32_t m_size; //!< the size of the packet
+  uint32_t m_messagesSize; //!< the size of the messages
+  uint16_t m_tlvSize; //!< the size of the packet TLVs
+  uint16_t m_seqnum; //!< the sequence number
+  uint8_t m_flags; //!< the packet flags
+};
+
+/**
+ * \brief Builder of PacketBB packets for transmission.
+ *
+ * PbbPacket stores every TLV, message, address block and address in an
+ * object of its own, linked in lists.  This header stores them instead
+ * in a few contiguous vectors owned by the builder, which keep their
+ * capacity across Clear, so that a builder reused for every control
+ * message stops allocating once warmed up.  The head and tail shared by
+ * the addresses of a block are computed once, by GetSerializedSize, and
+ * reused by Serialize.
+ *
+ * Elements are appended in the order of the encoding: the packet TLVs,
+ * then each message with its TLVs, then its address blocks with their
+ * addresses, prefixes and address TLVs.  AddTlv and the SetTlv methods
+ * apply to the packet, message or address block added last:
+ *
+ * \code
+ *   builder.Clear ();
+ *   builder.SetSequenceNumber (seq);
+ *   builder.AddMessage (HELLO, IPV4);
+ *   builder.SetOriginatorAddress (self);
+ *   builder.AddTlv (VALIDITY_TIME);
+ *   builder.SetTlvValue (&vtime, 1);
+ *   builder.AddAddressBlock ();
+ *   builder.AddAddress (neighbor);
+ *   packet->AddHeader (builder);
+ * \endcode
+ *
+ * The packets built serialize exactly as the equivalent PbbPacket.
+ */
+class PbbPacketBuilder : public Header
+{
+public:
+  PbbPacketBuilder (void);
+
+  /**
+   * \brief Removes all the elements, keeping the memory for the next packet.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Sets the sequence number of the packet.
+   * \param number the sequence number.
+   */
+  void SetSequenceNumber (uint16_t number);
+
+  /**
+   * \brief Appends a message to the packet.
+   * \param type the message type.
+   * \param addressLength the length of the addresses of the message.
+   */
+  void AddMessage (uint8_t type, PbbAddressLength addressLength);
+  /**
+   * \brief Sets the originator address of the last message.
+   * \param address the originator address.
+   */
+  void SetOriginatorAddress (Address address);
+  /**
+   * \brief Sets the hop limit of the last message.
+   * \param hoplimit the hop limit.
+   */
+  void SetHopLimit (uint8_t hoplimit);
+  /**
+   * \brief Sets the hop count of the last message.
+   * \param hopcount the hop count.
+   */
+  void SetHopCount (uint8_t hopcount);
+  /**
+   * \brief Sets the sequence number of the last message.
+   * \param number the sequence number.
+   */
+  void SetMessageSequenceNumber (uint16_t number);
+  /**
+   * \return the number of messages in the packet.
+   */
+  uint32_t GetNMessages (void) const;
+
+  /**
+   * \brief Appends an address block to the last message.
+   */
+  void AddAddressBlock (void);
+  /**
+   * \brief Appends an address to the last address block.
+   * \param address the address, of the length of the message.
+   */
+  void AddAddress (Address address);
+  /**
+   * \brief Appends a prefix length to the last address block.
+   * \param prefix the prefix length.
+   */
+  void AddPrefix (uint8_t prefix);
+
+  /**
+   * \brief Appends a TLV to the packet, message or address block added last.
+   * \param type the TLV type.
+   */
+  void AddTlv (uint8_t type);
+  /**
+   * \brief Sets the type extension of the last TLV.
+   * \param type the type extension.
+   */
+  void SetTlvTypeExt (uint8_t type);
+  /**
+   * \brief Sets the value of the last TLV.
+   * \param value the value bytes, copied.
+   * \param size the number of bytes.
+   */
+  void SetTlvValue (const uint8_t *value, uint16_t size);
+  /**
+   * \brief Sets the index of the first address the last TLV applies to.
+   * \param index the index.
+   */
+  void SetTlvIndexStart (uint8_t index);
+  /**
+   * \brief Sets the index of the last address the last TLV applies to.
+   * \param index the index.
+   *
+   * The start index must have been set first.
+   */
+  void SetTlvIndexStop (uint8_t index);
+  /**
+   * \brief Sets whether or not the value of the last TLV is multivalue.
+   * \param isMultivalue whether the value is multivalue.
+   */
+  void SetTlvMultivalue (bool isMultivalue);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \return the TypeId of PbbPacket
+   *
+   * The packets built are recorded in the packet metadata as PbbPackets,
+   * so that they are printed, and removed by the receivers, as such.
+   */
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  /**
+   * \brief Not supported: use PbbPacket or PbbPacketView to read packets.
+   * \param start start offset
+   * \return zero
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  /**
+   * \brief A TLV
+   */
+  struct Tlv
+  {
+    uint32_t valueStart; //!< the offset of the value in m_values
+    uint16_t valueSize; //!< the size of the value
+    uint8_t type; //!< the type
+    uint8_t typeExt; //!< the type extension
+    uint8_t indexStart; //!< the start index
+    uint8_t indexStop; //!< the stop index
+    uint8_t flags; //!< the TLV flags, without the value length flag
+  };
+  /**
+   * \brief A range of TLVs in m_tlvs
+   */
+  struct TlvRange
+  {
+    uint32_t start; //!< the first TLV
+    uint32_t count; //!< the number of TLVs
+  };
+  /**
+   * \brief An address block
+   */
+  struct AddressBlock
+  {
+    TlvRange tlvs; //!< the address TLVs
+    uint32_t addressStart; //!< the offset of the addresses in m_addresses
+    uint32_t prefixStart; //!< the offset of the prefixes in m_prefixes
+    uint16_t addressCount; //!< the number of addresses
+    uint16_t prefixCount; //!< the number of prefixes
+    uint8_t addressLength; //!< the size of the addresses: 4 or 16
+    mutable bool compressed; //!< true once the head and the tail are known
+    mutable bool zeroTail; //!< true if the tail is made of zeroes
+    mutable uint8_t headLength; //!< the size of the head
+    mutable uint8_t tailLength; //!< the size of the tail
+  };
+  /**
+   * \brief A message
+   */
+  struct Message
+  {
+    TlvRange tlvs; //!< the message TLVs
+    uint32_t blockStart; //!< the first address block in m_blocks
+    uint32_t blockCount; //!< the number of address blocks
+    uint16_t seqnum; //!< the sequence number
+    uint8_t type; //!< the type
+    uint8_t flags; //!< the message flags and address length
+    uint8_t originator[16]; //!< the originator address
+    uint8_t hopLimit; //!< the hop limit
+    uint8_t hopCount; //!< the hop count
+  };
+  /// The element TLVs are appended to
+  enum Scope
+  {
+    PACKET,
+    MESSAGE,
+    ADDRESS_BLOCK
+  };
+
+  /**
+   * \brief Finds the head and the tail shared by the addresses of a block.
+   * \param block the address block
+   */
+  void Compress (const AddressBlock &block) const;
+  /**
+   * \param tlvs a range of TLVs
+   * \return the size of the TLV block, including its size field
+   */
+  uint32_t GetTlvBlockSize (const TlvRange &tlvs) const;
+  /**
+   * \param block an address block
+   * \return the size of the block
+   */
+  uint32_t GetAddressBlockSize (const AddressBlock &block) const;
+  /**
+   * \param message a message
+   * \return the size of the message
+   */
+  uint32_t GetMessageSize (const Message &message) const;
+  /**
+   * \brief Serializes a TLV block.
+   * \param start where to write
+   * \param tlvs a range of TLVs
+   */
+  void SerializeTlvBlock (Buffer::Iterator &start, const TlvRange &tlvs) const;
+  /**
+   * \brief Serializes an address block.
+   * \param start where to write
+   * \param block the address block
+   */
+  void SerializeAddressBlock (Buffer::Iterator &start, const AddressBlock &block) const;
+  /**
+   * \return the last TLV added
+   */
+  Tlv &GetLastTlv (void);
+
+  std::vector<Tlv> m_tlvs; //!< the TLVs of the packet, messages and address blocks
+  std::vector<AddressBlock> m_blocks; //!< the address blocks of all the messages
+  std::vector<Message> m_messages; //!< the messages
+  std::vector<uint8_t> m_addresses; //!< the bytes of all the addresses
+  std::vector<uint8_t> m_prefixes; //!< the prefixes of all the address blocks
+  std::vector<uint8_t> m_values; //!< the bytes of all the TLV values
+  TlvRange m_packetTlvs; //!< the packet TLVs
+  Scope m_scope; //!< where AddTlv appends
+  bool m_hasseqnum; //!< Sequence number present
+  uint16_t m_seqnum; //!< Sequence number
+};
+
 } /* namespace ns3 */
 
 #endif /* PACKETBB_H */
@@ -0,0 +1,328 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "pcap-file-reader.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapFileReader");
+
+const uint32_t MAGIC = 0xa1b2c3d4;            /**< Magic number identifying standard pcap file format */
+const uint32_t SWAPPED_MAGIC = 0xd4c3b2a1;    /**< Looks this way if byte swapping is required */
+
+const uint32_t NS_MAGIC = 0xa1b23c4d;         /**< Magic number identifying nanosec resolution pcap file format */
+const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swapping is required */
+
+const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
+const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
+
+const uint32_t FILE_HEADER_SIZE = 24;         /**< Size of the pcap file header */
+const uint32_t RECORD_HEADER_SIZE = 16;       /**< Size of a pcap record header */
+
+/**
+ * \param val a 32 bit value
+ * \returns the value with byte order swapped
+ */
+static uint32_t
+Swap32 (uint32_t val)
+{
+  return ((val >> 24) & 0x000000ff) | ((val >> 8) & 0x0000ff00) | ((val << 8) & 0x00ff0000) | ((val << 24) & 0xff000000);
+}
+
+PcapFileReader::PcapFileReader ()
+  : m_next (0),
+    m_swapMode (false),
+    m_nanosecMode (false),
+    m_snapLen (0),
+    m_dataLinkType (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapFileReader::~PcapFileReader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+PcapFileReader::Read32 (uint64_t offset) const
+{
+  uint32_t val;
+  memcpy (&val, m_file.GetData () + offset, sizeof (val));
+  return m_swapMode ? Swap32 (val) : val;
+}
+
+bool
+PcapFileReader::OpenFile (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  if (!m_file.Open (filename) || m_file.GetSize () < FILE_HEADER_SIZE)
+    {
+      Close ();
+      return false;
+    }
+
+  uint32_t magic;
+  memcpy (&magic, m_file.GetData (), sizeof (magic));
+  if (magic != MAGIC && magic != SWAPPED_MAGIC && magic != NS_MAGIC && magic != NS_SWAPPED_MAGIC)
+    {
+      Close ();
+      return false;
+    }
+  m_swapMode = magic == SWAPPED_MAGIC || magic == NS_SWAPPED_MAGIC;
+  m_nanosecMode = magic == NS_MAGIC || magic == NS_SWAPPED_MAGIC;
+
+  // the major and the minor versions are the two 16 bit fields after the magic
+  uint16_t versions[2];
+  memcpy (versions, m_file.GetData () + 4, sizeof (versions));
+  if (m_swapMode)
+    {
+      versions[0] = (versions[0] >> 8) | (versions[0] << 8);
+      versions[1] = (versions[1] >> 8) | (versions[1] << 8);
+    }
+  int32_t zone = Read32 (8);
+  if (versions[0] != VERSION_MAJOR || versions[1] != VERSION_MINOR || zone < -12 || zone > 12)
+    {
+      NS_LOG_LOGIC ("Unsupported version " << versions[0] << "." << versions[1] << " or zone " << zone);
+      Close ();
+      return false;
+    }
+  m_snapLen = Read32 (16);
+  m_dataLinkType = Read32 (20);
+  m_next = FILE_HEADER_SIZE;
+  return true;
+}
+
+bool
+PcapFileReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (!OpenFile (filename))
+    {
+      return false;
+    }
+
+  uint64_t offset = FILE_HEADER_SIZE;
+  uint64_t size = m_file.GetSize ();
+  while (offset + RECORD_HEADER_SIZE <= size)
+    {
+      uint64_t next = offset + RECORD_HEADER_SIZE + Read32 (offset + 8);
+      if (next > size)
+        {
+          NS_LOG_LOGIC ("Truncated record at offset " << offset);
+          break;
+        }
+      m_index.push_back (offset);
+      offset = next;
+    }
+  return true;
+}
+
+bool
+PcapFileReader::OpenSequential (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  return OpenFile (filename);
+}
+
+void
+PcapFileReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+  std::vector<uint64_t> ().swap (m_index);
+  m_next = 0;
+  m_swapMode = false;
+  m_nanosecMode = false;
+  m_snapLen = 0;
+  m_dataLinkType = 0;
+}
+
+uint32_t
+PcapFileReader::GetNPackets (void) const
+{
+  return m_index.size ();
+}
+
+PcapFileReader::Record
+PcapFileReader::GetRecord (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT_MSG (index < m_index.size (), "No record " << index);
+  return ReadRecord (m_index[index]);
+}
+
+PcapFileReader::Record
+PcapFileReader::ReadRecord (uint64_t offset) const
+{
+  Record record;
+  record.m_tsSec = Read32 (offset);
+  record.m_tsUsec = Read32 (offset + 4);
+  record.m_inclLen = Read32 (offset + 8);
+  record.m_origLen = Read32 (offset + 12);
+  record.m_data = m_file.GetData () + offset + RECORD_HEADER_SIZE;
+  return record;
+}
+
+uint32_t
+PcapFileReader::Seek (uint32_t tsSec, uint32_t tsUsec) const
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec);
+  uint32_t first = 0;
+  uint32_t last = m_index.size ();
+  while (first < last)
+    {
+      uint32_t middle = first + (last - first) / 2;
+      uint64_t offset = m_index[middle];
+      uint32_t sec = Read32 (offset);
+      uint32_t usec = Read32 (offset + 4);
+      if (sec < tsSec || (sec == tsSec && usec < tsUsec))
+        {
+          first = middle + 1;
+        }
+      else
+        {
+          last = middle;
+        }
+    }
+  return first;
+}
+
+bool
+PcapFileReader::ReadNext (Record &record)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_next + RECORD_HEADER_SIZE > m_file.GetSize ())
+    {
+      return false;
+    }
+  uint64_t next = m_next + RECORD_HEADER_SIZE + Read32 (m_next + 8);
+  if (next > m_file.GetSize ())
+    {
+      NS_LOG_LOGIC ("Truncated record at offset " << m_next);
+      return false;
+    }
+  record = ReadRecord (m_next);
+  m_next = next;
+  return true;
+}
+
+void
+PcapFileReader::ReleaseRead (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Release (m_next);
+}
+
+void
+PcapFileReader::AdviseSequential (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.AdviseSequential ();
+}
+
+void
+PcapFileReader::Release (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_file.Release (index < m_index.size () ? m_index[index] : m_file.GetSize ());
+}
+
+bool
+PcapFileReader::GetSwapMode (void) const
+{
+  return m_swapMode;
+}
+
+bool
+PcapFileReader::IsNanoSecMode (void) const
+{
+  return m_nanosecMode;
+}
+
+uint32_t
+PcapFileReader::GetSnapLen (void) const
+{
+  return m_snapLen;
+}
+
+uint32_t
+PcapFileReader::GetDataLinkType (void) const
+{
+  return m_dataLinkType;
+}
+
+bool
+PcapFileReader::Diff (std::string const & f1, std::string const & f2,
+                      uint32_t & sec, uint32_t & usec, uint32_t & packets,
+                      uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (f1 << f2 << sec << usec << snapLen);
+  PcapFileReader pcap1, pcap2;
+  if (!pcap1.Open (f1) || !pcap2.Open (f2))
+    {
+      return true;
+    }
+
+  uint32_t n1 = pcap1.GetNPackets ();
+  uint32_t n2 = pcap2.GetNPackets ();
+  uint32_t n = std::min (n1, n2);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Record r1 = pcap1.GetRecord (i);
+      Record r2 = pcap2.GetRecord (i);
+      ++packets;
+      sec = r1.m_tsSec;
+      usec = r1.m_tsUsec;
+
+      if (r1.m_tsSec != r2.m_tsSec || r1.m_tsUsec != r2.m_tsUsec)
+        {
+          return true; // Next packet timestamps do not match
+        }
+
+      // only the first snapLen bytes of the packets are compared
+      uint32_t len1 = std::min (r1.m_inclLen, snapLen);
+      uint32_t len2 = std::min (r2.m_inclLen, snapLen);
+      if (len1 != len2)
+        {
+          return true; // Packet lengths do not match
+        }
+
+      if (std::memcmp (r1.m_data, r2.m_data, len1) != 0)
+        {
+          return true; // Packet data do not match
+        }
+    }
+
+  if (n1 != n2)
+    {
+      if (n1 > n)
+        {
+          sec = pcap1.GetRecord (n).m_tsSec;
+          usec = pcap1.GetRecord (n).m_tsUsec;
+        }
+      return true; // One of the files has more packets
+    }
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_FILE_READER_H
+#define PCAP_FILE_READER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "mapped-file.h"
+
+namespace ns3 {
+
+/**
+ * \brief A pcap file mapped in memory, with random access to its records
+ *
+ * The file is mapped when it is opened, and the offsets of all its
+ * records are collected, so that any record can then be reached by its
+ * number, or by its timestamp, without reading the records before it.
+ * The packet data of a record is returned as a pointer into the mapped
+ * file, valid until the file is closed, instead of being copied.
+ *
+ * A file opened with OpenSequential is not indexed: its records are only
+ * read in order with ReadNext, and the memory used does not depend on the
+ * number of records.
+ *
+ * Unlike PcapFile, the reader only reads the files: use PcapFile to
+ * write them.
+ */
+class PcapFileReader
+{
+public:
+  /**
+   * \brief A record of the file
+   */
+  struct Record
+  {
+    uint32_t m_tsSec;         /**< seconds part of timestamp */
+    uint32_t m_tsUsec;        /**< microseconds part of timestamp (nanoseconds in nanosecond mode) */
+    uint32_t m_inclLen;       /**< number of octets of packet saved in file */
+    uint32_t m_origLen;       /**< actual length of original packet */
+    const uint8_t *m_data;    /**< the m_inclLen octets saved, in the mapped file */
+  };
+
+  PcapFileReader ();
+  ~PcapFileReader ();
+
+  /**
+   * \brief Map a pcap file and index its records.
+   *
+   * A record cut short by the end of the file is ignored.
+   *
+   * \param filename String containing the name of the file.
+   * \returns true if the file is a valid pcap file, false otherwise
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * \brief Map a pcap file without indexing its records.
+   *
+   * The records can then only be read with ReadNext: GetNPackets returns
+   * 0, and GetRecord, Seek and Release must not be used.
+   *
+   * \param filename String containing the name of the file.
+   * \returns true if the file is a valid pcap file, false otherwise
+   */
+  bool OpenSequential (std::string const &filename);
+
+  /**
+   * Unmap the file.
+   */
+  void Close (void);
+
+  /**
+   * \returns the number of records of the file
+   */
+  uint32_t GetNPackets (void) const;
+
+  /**
+   * \brief Get a record.
+   *
+   * \param index the number of the record, from 0
+   * \returns the record
+   */
+  Record GetRecord (uint32_t index) const;
+
+  /**
+   * \brief Find the first record at or after a time.
+   *
+   * The records are expected to be in time order, as they are when
+   * written by PcapFile.
+   *
+   * \param tsSec seconds part of the time
+   * \param tsUsec microseconds part of the time, or nanoseconds in
+   *        nanosecond mode
+   * \returns the number of the record, GetNPackets () if none
+   */
+  uint32_t Seek (uint32_t tsSec, uint32_t tsUsec) const;
+
+  /**
+   * \brief Read the records in order.
+   *
+   * The first call returns the first record of the file, and each call
+   * the record after the one returned by the previous call.
+   *
+   * \param record [out] the record
+   * \returns false once the records are exhausted, or on a record cut
+   *          short by the end of the file
+   */
+  bool ReadNext (Record &record);
+  /**
+   * \brief Release the pages of the records returned by ReadNext.
+   *
+   * The pages are read again from the file if these records are
+   * accessed later.
+   */
+  void ReleaseRead (void);
+
+  /**
+   * \brief Hint that the records will be read in order.
+   */
+  void AdviseSequential (void);
+  /**
+   * \brief Release the pages of the records before a record.
+   *
+   * The pages are read again from the file if these records are
+   * accessed later.
+   *
+   * \param index the number of the first record still needed
+   */
+  void Release (uint32_t index);
+
+  /**
+   * \returns true if the fields of the file are byte swapped
+   */
+  bool GetSwapMode (void) const;
+  /**
+   * \returns true if the timestamps have nanosecond resolution
+   */
+  bool IsNanoSecMode (void) const;
+  /**
+   * \returns the maximum length of saved packets of the file
+   */
+  uint32_t GetSnapLen (void) const;
+  /**
+   * \returns the data link type of the file
+   */
+  uint32_t GetDataLinkType (void) const;
+
+  /**
+   * \brief Compare two PCAP files packet-by-packet
+   *
+   * \see PcapFile::Diff
+   *
+   * \return true if files are different, false otherwise
+   *
+   * \param  f1         First PCAP file name
+   * \param  f2         Second PCAP file name
+   * \param  sec        [out] Time stamp of first different packet, seconds. Undefined if files doesn't differ.
+   * \param  usec       [out] Time stamp of first different packet, microseconds. Undefined if files doesn't differ.
+   * \param  packets    [out] Number of first different packet. Total number of parsed packets if files doesn't differ.
+   * \param  snapLen    Snap length (if used)
+   */
+  static bool Diff (std::string const & f1, std::string const & f2,
+                    uint32_t & sec, uint32_t & usec, uint32_t & packets,
+                    uint32_t snapLen);
+
+private:
+  /**
+   * \brief Copy constructor, not implemented.
+   * \param o object to copy
+   */
+  PcapFileReader (const PcapFileReader &o);
+  /**
+   * \brief Assignment operator, not implemented.
+   * \param o object to copy
+   * \returns this object
+   */
+  PcapFileReader &operator = (const PcapFileReader &o);
+
+  /**
+   * \brief Read a 32 bit field of the file.
+   * \param offset the offset of the field
+   * \returns the field value, in host byte order
+   */
+  uint32_t Read32 (uint64_t offset) const;
+  /**
+   * \brief Map a file and read its pcap file header.
+   * \param filename String containing the name of the file.
+   * \returns true if the file is a valid pcap file, false otherwise
+   */
+  bool OpenFile (std::string const &filename);
+  /**
+   * \brief Read the record at an offset.
+   * \param offset the offset of the record header
+   * \returns the record
+   */
+  Record ReadRecord (uint64_t offset) const;
+
+  MappedFile m_file;              //!< the mapped file
+  std::vector<uint64_t> m_index;  //!< the offset of every record
+  uint64_t m_next;                //!< the offset of the record returned by ReadNext
+  bool m_swapMode;                //!< swap mode
+  bool m_nanosecMode;             //!< nanosecond timestamp mode
+  uint32_t m_snapLen;             //!< maximum length of saved packets
+  uint32_t m_dataLinkType;        //!< data link type
+};
+
+} // namespace ns3
+
+#endif /* PCAP_FILE_READER_H */
@@ -21,6 +21,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/simulator.h"
 #include "pcap-file-wrapper.h"
 
 namespace ns3 {
@@ -46,12 +47,28 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("WriteBlockSize",
+                   "Size in bytes of the blocks in which the packets are formatted before "
+                   "a background thread writes them to the file. Zero writes every packet "
+                   "to the file synchronously.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_blockSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("WriteBlockCount",
+                   "Maximum number of blocks kept in memory when WriteBlockSize is not zero. "
+                   "Writing a packet blocks while they all wait for the background thread.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_blockCount),
+                   MakeUintegerChecker<uint32_t> (2))
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_interface (0),
+    m_interfaceSnapLen (0),
+    m_dataLinkType (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +83,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return m_pcapng->Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -73,6 +94,10 @@ bool
 PcapFileWrapper::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return false;
+    }
   return m_file.Eof ();
 }
 void 
@@ -86,6 +111,7 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  m_pcapng = 0;
   m_file.Close ();
 }
 
@@ -94,6 +120,32 @@ PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
   m_file.Open (filename, mode);
+  if (m_blockSize > 0 && (mode & std::ios::out) && !m_file.Fail ())
+    {
+      m_file.EnableAsyncWrite (m_blockSize, m_blockCount);
+      // the event keeps this wrapper alive until the simulation ends
+      Simulator::ScheduleDestroy (&PcapFileWrapper::Flush, Ptr<PcapFileWrapper> (this));
+    }
+}
+
+void
+PcapFileWrapper::Open (Ptr<PcapngFile> file, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << file << name);
+  m_pcapng = file;
+  m_interfaceName = name;
+}
+
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Flush ();
+      return;
+    }
+  m_file.Flush ();
 }
 
 void
@@ -105,6 +157,15 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   // a snaplen, we use the one provided.
   //
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
+  if (m_pcapng != 0)
+    {
+      // pcapng timestamps are in UTC: the time zone correction does not apply
+      m_dataLinkType = dataLinkType;
+      m_interfaceSnapLen = snapLen != std::numeric_limits<uint32_t>::max () ? snapLen : m_snapLen;
+      m_interface = m_pcapng->AddInterface (m_dataLinkType, m_interfaceSnapLen,
+                                            m_interfaceName, m_nanosecMode);
+      return;
+    }
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
       m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
@@ -119,6 +180,11 @@ void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Write (m_interface, GetTimestamp (t), p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +205,11 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Write (m_interface, GetTimestamp (t), header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +230,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Write (m_interface, GetTimestamp (t), buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -175,9 +251,16 @@ PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
     }
 }
 
+uint64_t
+PcapFileWrapper::GetTimestamp (Time t) const
+{
+  return m_nanosecMode ? t.GetNanoSeconds () : t.GetMicroSeconds ();
+}
+
 Ptr<Packet> 
 PcapFileWrapper::Read (Time &t)
 {
+  NS_ASSERT_MSG (m_pcapng == 0, "Cannot read from a shared pcapng file");
   uint32_t tsSec;
   uint32_t tsUsec;
   uint32_t inclLen;
@@ -211,6 +294,10 @@ uint32_t
 PcapFileWrapper::GetMagic (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return 0;
+    }
   return m_file.GetMagic ();
 }
 
@@ -218,6 +305,10 @@ uint16_t
 PcapFileWrapper::GetVersionMajor (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return 0;
+    }
   return m_file.GetVersionMajor ();
 }
 
@@ -225,6 +316,10 @@ uint16_t
 PcapFileWrapper::GetVersionMinor (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return 0;
+    }
   return m_file.GetVersionMinor ();
 }
 
@@ -232,6 +327,10 @@ int32_t
 PcapFileWrapper::GetTimeZoneOffset (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return 0;
+    }
   return m_file.GetTimeZoneOffset ();
 }
 
@@ -239,6 +338,10 @@ uint32_t
 PcapFileWrapper::GetSigFigs (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return 0;
+    }
   return m_file.GetSigFigs ();
 }
 
@@ -246,6 +349,10 @@ uint32_t
 PcapFileWrapper::GetSnapLen (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return m_interfaceSnapLen;
+    }
   return m_file.GetSnapLen ();
 }
 
@@ -253,6 +360,10 @@ uint32_t
 PcapFileWrapper::GetDataLinkType (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return m_dataLinkType;
+    }
   return m_file.GetDataLinkType ();
 }
 
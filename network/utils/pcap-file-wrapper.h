@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file.h"
 
 namespace ns3 {
 
@@ -78,10 +79,34 @@ public:
   void Open (std::string const &filename, std::ios::openmode mode);
 
   /**
-   * Close the underlying pcap file.
+   * Write the packets of this wrapper to an interface of a shared pcapng
+   * file instead of a pcap file of their own.
+   *
+   * The interface is described in the pcapng file by Init, which must
+   * be called next, as after the other Open method.  Reading is not
+   * supported, and the getters which do not describe the interface
+   * (magic, versions, time zone, sigfigs) return zero.
+   *
+   * \param file the shared pcapng file, already open
+   * \param name the name of the interface, such as the name the pcap
+   *        file of the device would have had
+   */
+  void Open (Ptr<PcapngFile> file, std::string const &name);
+
+  /**
+   * Close the underlying pcap file, or detach from the shared pcapng file.
    */
   void Close (void);
 
+  /**
+   * Write all the packets written so far to the underlying pcap file.
+   *
+   * When the "WriteBlockSize" attribute is not zero, the packets are
+   * written by a background thread, and this waits until it is done.
+   * This is done automatically at Simulator::Destroy.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -221,9 +246,22 @@ public:
   uint32_t GetDataLinkType (void);
 
 private:
+  /**
+   * \param t a time
+   * \returns the time in the timestamp unit of the file
+   */
+  uint64_t GetTimestamp (Time t) const;
+
   PcapFile m_file; //!< Pcap file
+  Ptr<PcapngFile> m_pcapng; //!< Shared pcapng file, 0 to use m_file
+  std::string m_interfaceName; //!< Name of the interface in the pcapng file
+  uint32_t m_interface; //!< Interface identifier in the pcapng file
+  uint32_t m_interfaceSnapLen; //!< max length of saved packets of the interface
+  uint32_t m_dataLinkType; //!< Data link type of the interface
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_blockSize; //!< size of the blocks of the writer thread, 0 to write synchronously
+  uint32_t m_blockCount; //!< maximum number of blocks of the writer thread
 };
 
 } // namespace ns3
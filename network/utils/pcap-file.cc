@@ -27,6 +27,8 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "pcap-file-reader.h"
+#include "async-file-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -50,7 +52,8 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -59,8 +62,8 @@ PcapFile::PcapFile ()
 PcapFile::~PcapFile ()
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::UnregisterStream (&m_file);
   Close ();
+  FatalImpl::UnregisterStream (&m_file);
 }
 
 
@@ -68,6 +71,11 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      // the stream belongs to the writer thread
+      return m_writer->Fail ();
+    }
   return m_file.fail ();
 }
 bool 
@@ -88,9 +96,77 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      FatalImpl::UnregisterStream (m_writer->GetDrainStream ());
+      delete m_writer;
+      m_writer = 0;
+      FatalImpl::RegisterStream (&m_file);
+    }
   m_file.close ();
 }
 
+void
+PcapFile::EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks)
+{
+  NS_LOG_FUNCTION (this << blockSize << maxBlocks);
+  NS_ASSERT (m_writer == 0);
+  // the stream now belongs to the writer thread: on a fatal error, it
+  // is flushed by waiting for the writer thread instead
+  FatalImpl::UnregisterStream (&m_file);
+  m_writer = new AsyncFileWriter (&m_file, blockSize, maxBlocks);
+  FatalImpl::RegisterStream (m_writer->GetDrainStream ());
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Flush ();
+    }
+  else
+    {
+      m_file.flush ();
+    }
+}
+
+void
+PcapFile::Output (const uint8_t *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+  if (m_writer != 0)
+    {
+      m_writer->Write (data, size);
+    }
+  else
+    {
+      m_file.write ((const char *)data, size);
+    }
+}
+
+void
+PcapFile::Output (Ptr<const Packet> p, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << p << size);
+  if (m_writer == 0)
+    {
+      p->CopyData (&m_file, size);
+    }
+  else if (size <= m_writer->GetBlockSize ())
+    {
+      p->CopyData (m_writer->Reserve (size), size);
+    }
+  else
+    {
+      uint8_t *data = new uint8_t [size];
+      p->CopyData (data, size);
+      m_writer->Write (data, size);
+      delete [] data;
+    }
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -204,8 +280,12 @@ PcapFile::WriteFileHeader (void)
   NS_LOG_FUNCTION (this);
   //
   // If we're initializing the file, we need to write the pcap file header
-  // at the start of the file.
+  // at the start of the file. The writer thread must be idle to seek.
   //
+  if (m_writer != 0)
+    {
+      m_writer->Flush ();
+    }
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -403,7 +483,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_writer != 0 || m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -419,14 +499,15 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
-  // them all individually.
+  // Watch out for memory alignment differences between machines, so copy
+  // them all individually, then write the record header at once.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  uint8_t record[16];
+  memcpy (record, &header.m_tsSec, sizeof(header.m_tsSec));
+  memcpy (record + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+  memcpy (record + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+  memcpy (record + 12, &header.m_origLen, sizeof(header.m_origLen));
+  Output (record, sizeof (record));
   return inclLen;
 }
 
@@ -435,8 +516,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  Output (data, inclLen);
+  if (m_writer == 0)
+    {
+      NS_BUILD_DEBUG(m_file.flush());
+    }
 }
 
 void 
@@ -444,8 +528,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  Output (p, inclLen);
+  if (m_writer == 0)
+    {
+      NS_BUILD_DEBUG(m_file.flush());
+    }
 }
 
 void 
@@ -460,9 +547,19 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  if (m_writer == 0)
+    {
+      headerBuffer.CopyData (&m_file, toCopy);
+    }
+  else
+    {
+      uint8_t *headerData = new uint8_t [toCopy];
+      headerBuffer.CopyData (headerData, toCopy);
+      m_writer->Write (headerData, toCopy);
+      delete [] headerData;
+    }
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  Output (p, inclLen);
 }
 
 void
@@ -530,79 +627,8 @@ PcapFile::Diff (std::string const & f1, std::string const & f2,
                 uint32_t snapLen)
 {
   NS_LOG_FUNCTION (f1 << f2 << sec << usec << snapLen);
-  PcapFile pcap1, pcap2;
-  pcap1.Open (f1, std::ios::in);
-  pcap2.Open (f2, std::ios::in);
-  bool bad = pcap1.Fail () || pcap2.Fail ();
-  if (bad)
-    {
-      return true;
-    }
-
-  uint8_t *data1 = new uint8_t [snapLen] ();
-  uint8_t *data2 = new uint8_t [snapLen] ();
-  uint32_t tsSec1 = 0;
-  uint32_t tsSec2 = 0;
-  uint32_t tsUsec1 = 0;
-  uint32_t tsUsec2 = 0;
-  uint32_t inclLen1 = 0;
-  uint32_t inclLen2 = 0;
-  uint32_t origLen1 = 0;
-  uint32_t origLen2 = 0;
-  uint32_t readLen1 = 0;
-  uint32_t readLen2 = 0;
-  bool diff = false;
-
-  while (!pcap1.Eof () && !pcap2.Eof ())
-    {
-      pcap1.Read (data1, snapLen, tsSec1, tsUsec1, inclLen1, origLen1, readLen1);
-      pcap2.Read (data2, snapLen, tsSec2, tsUsec2, inclLen2, origLen2, readLen2);
-
-      bool same = pcap1.Fail () == pcap2.Fail ();
-      if (!same)
-        {
-          diff = true;
-          break;
-        }
-      if (pcap1.Eof ())
-        {
-          break;
-        }
-
-      ++packets;
-      
-      if (tsSec1 != tsSec2 || tsUsec1 != tsUsec2)
-        {
-          diff = true; // Next packet timestamps do not match
-          break;
-        }
-
-      if (readLen1 != readLen2)
-        {
-          diff = true; // Packet lengths do not match
-          break;
-        }
-
-      if (std::memcmp (data1, data2, readLen1) != 0)
-        {
-          diff = true; // Packet data do not match
-          break;
-        }
-    }
-  sec = tsSec1;
-  usec = tsUsec1;
-
-  bad = pcap1.Fail () || pcap2.Fail ();
-  bool eof = pcap1.Eof () && pcap2.Eof ();
-  if (bad && !eof)
-    {
-      diff = true;
-    }
-
-  delete[] data1;
-  delete[] data2;
-
-  return diff;
+  // compare the mapped files in place rather than copying every record
+  return PcapFileReader::Diff (f1, f2, sec, usec, packets, snapLen);
 }
 
 } // namespace ns3
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class AsyncFileWriter;
 
 
 /**
@@ -85,6 +86,29 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the records of this file from a background thread.
+   *
+   * The records are formatted into blocks of blockSize bytes, and full
+   * blocks are written to the file by a writer thread. At most maxBlocks
+   * blocks are kept in memory: when they are all waiting to be written,
+   * Write blocks until the writer thread has written one of them. The
+   * file must have been opened with write permissions. The pending
+   * blocks are written on Close, and on a fatal error.
+   *
+   * \param blockSize the size of the blocks, in bytes
+   * \param maxBlocks the maximum number of blocks, at least 2
+   */
+  void EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks);
+
+  /**
+   * Write all the records written so far to the file.
+   *
+   * With asynchronous writes, this waits until the writer thread has
+   * written every pending block.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -361,6 +385,20 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Write bytes to the file, or to the blocks of the writer thread
+   * \param data the bytes to write
+   * \param size the number of bytes
+   */
+  void Output (const uint8_t *data, uint32_t size);
+  /**
+   * \brief Write the first bytes of a packet to the file, or to the blocks
+   * of the writer thread
+   * \param p the packet
+   * \param size the number of bytes
+   */
+  void Output (Ptr<const Packet> p, uint32_t size);
+
   /**
    * \brief Read and verify a Pcap file header
    */
@@ -371,6 +409,7 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  AsyncFileWriter *m_writer;    //!< writer thread, or 0 to write synchronously
 };
 
 } // namespace ns3
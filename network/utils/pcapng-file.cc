@@ -0,0 +1,334 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "pcapng-file.h"
+#include "async-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapngFile");
+
+const uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a;     /**< Section Header Block type */
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 1;       /**< Interface Description Block type */
+const uint32_t ENHANCED_PACKET_BLOCK = 6;             /**< Enhanced Packet Block type */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;         /**< Identifies the byte order of a section */
+const uint16_t VERSION_MAJOR = 1;                     /**< Major version of the pcapng format */
+const uint16_t VERSION_MINOR = 0;                     /**< Minor version of the pcapng format */
+const uint16_t OPT_ENDOFOPT = 0;                      /**< End of the options of a block */
+const uint16_t IF_NAME = 2;                           /**< Interface name option */
+const uint16_t IF_TSRESOL = 9;                        /**< Interface timestamp resolution option */
+
+/**
+ * \param size a size in bytes
+ * \returns the size rounded up to a multiple of 32 bits
+ */
+static uint32_t
+Pad32 (uint32_t size)
+{
+  return (size + 3) & ~3U;
+}
+
+/**
+ * \brief Append a 16 bit value to a block.
+ *
+ * \param block the block
+ * \param v the value
+ */
+static void
+Append16 (std::vector<uint8_t> &block, uint16_t v)
+{
+  uint8_t *p = reinterpret_cast<uint8_t *> (&v);
+  block.insert (block.end (), p, p + sizeof (v));
+}
+
+/**
+ * \brief Append a 32 bit value to a block.
+ *
+ * \param block the block
+ * \param v the value
+ */
+static void
+Append32 (std::vector<uint8_t> &block, uint32_t v)
+{
+  uint8_t *p = reinterpret_cast<uint8_t *> (&v);
+  block.insert (block.end (), p, p + sizeof (v));
+}
+
+/**
+ * \brief Append an option to a block, padded to 32 bits.
+ *
+ * \param block the block
+ * \param code the option code
+ * \param value the option value
+ * \param length the length of the value
+ */
+static void
+AppendOption (std::vector<uint8_t> &block, uint16_t code, const uint8_t *value, uint16_t length)
+{
+  Append16 (block, code);
+  Append16 (block, length);
+  block.insert (block.end (), value, value + length);
+  block.resize (block.size () + Pad32 (length) - length, 0);
+}
+
+/**
+ * \brief Write the block type and length into a block, and append the
+ * trailing length.
+ *
+ * \param block the block, with room for the type and the length at the start
+ * \param type the block type
+ */
+static void
+Seal (std::vector<uint8_t> &block, uint32_t type)
+{
+  uint32_t length = block.size () + 4;
+  memcpy (&block[0], &type, 4);
+  memcpy (&block[4], &length, 4);
+  Append32 (block, length);
+}
+
+PcapngFile::PcapngFile ()
+  : m_writer (0)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+PcapngFile::~PcapngFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  FatalImpl::UnregisterStream (&m_file);
+}
+
+bool
+PcapngFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      // the stream belongs to the writer thread
+      return m_writer->Fail ();
+    }
+  return m_file.fail ();
+}
+
+void
+PcapngFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT (!m_file.is_open ());
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  m_snapLens.clear ();
+
+  std::vector<uint8_t> block (8);
+  Append32 (block, BYTE_ORDER_MAGIC);
+  Append16 (block, VERSION_MAJOR);
+  Append16 (block, VERSION_MINOR);
+  // the section length is not known in advance
+  Append32 (block, 0xffffffff);
+  Append32 (block, 0xffffffff);
+  Seal (block, SECTION_HEADER_BLOCK);
+  Output (&block[0], block.size ());
+}
+
+void
+PcapngFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      FatalImpl::UnregisterStream (m_writer->GetDrainStream ());
+      delete m_writer;
+      m_writer = 0;
+      FatalImpl::RegisterStream (&m_file);
+    }
+  m_file.close ();
+}
+
+void
+PcapngFile::EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks)
+{
+  NS_LOG_FUNCTION (this << blockSize << maxBlocks);
+  NS_ASSERT (m_writer == 0);
+  // the stream now belongs to the writer thread: on a fatal error, it
+  // is flushed by waiting for the writer thread instead
+  FatalImpl::UnregisterStream (&m_file);
+  m_writer = new AsyncFileWriter (&m_file, blockSize, maxBlocks);
+  FatalImpl::RegisterStream (m_writer->GetDrainStream ());
+}
+
+void
+PcapngFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Flush ();
+    }
+  else
+    {
+      m_file.flush ();
+    }
+}
+
+uint32_t
+PcapngFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen,
+                          std::string const &name, bool nanosecMode)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name << nanosecMode);
+  NS_ASSERT (dataLinkType <= 0xffff);
+  NS_ASSERT (name.size () <= 0xffff);
+
+  std::vector<uint8_t> block (8);
+  Append16 (block, dataLinkType);
+  Append16 (block, 0);
+  Append32 (block, snapLen);
+  if (!name.empty ())
+    {
+      AppendOption (block, IF_NAME, reinterpret_cast<const uint8_t *> (name.data ()), name.size ());
+    }
+  if (nanosecMode)
+    {
+      // the default resolution is the microsecond
+      uint8_t resolution = 9;
+      AppendOption (block, IF_TSRESOL, &resolution, 1);
+    }
+  AppendOption (block, OPT_ENDOFOPT, 0, 0);
+  Seal (block, INTERFACE_DESCRIPTION_BLOCK);
+  Output (&block[0], block.size ());
+
+  m_snapLens.push_back (snapLen);
+  return m_snapLens.size () - 1;
+}
+
+uint32_t
+PcapngFile::GetNInterfaces (void) const
+{
+  return m_snapLens.size ();
+}
+
+void
+PcapngFile::Output (const uint8_t *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+  if (m_writer != 0)
+    {
+      m_writer->Write (data, size);
+    }
+  else
+    {
+      m_file.write ((const char *)data, size);
+    }
+}
+
+void
+PcapngFile::Output (Ptr<const Packet> p, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << p << size);
+  if (m_writer == 0)
+    {
+      p->CopyData (&m_file, size);
+    }
+  else if (size <= m_writer->GetBlockSize ())
+    {
+      p->CopyData (m_writer->Reserve (size), size);
+    }
+  else
+    {
+      uint8_t *data = new uint8_t [size];
+      p->CopyData (data, size);
+      m_writer->Write (data, size);
+      delete [] data;
+    }
+}
+
+uint32_t
+PcapngFile::WritePacketHeader (uint32_t interface, uint64_t timestamp, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << totalLen);
+  NS_ASSERT_MSG (interface < m_snapLens.size (), "Unknown interface " << interface);
+
+  uint32_t inclLen = std::min (totalLen, m_snapLens[interface]);
+  uint32_t fields[7];
+  fields[0] = ENHANCED_PACKET_BLOCK;
+  fields[1] = 32 + Pad32 (inclLen);
+  fields[2] = interface;
+  fields[3] = timestamp >> 32;
+  fields[4] = timestamp & 0xffffffff;
+  fields[5] = inclLen;
+  fields[6] = totalLen;
+  Output (reinterpret_cast<const uint8_t *> (fields), sizeof (fields));
+  return inclLen;
+}
+
+void
+PcapngFile::WritePacketTrailer (uint32_t inclLen)
+{
+  NS_LOG_FUNCTION (this << inclLen);
+  uint8_t trailer[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  uint32_t padding = Pad32 (inclLen) - inclLen;
+  uint32_t length = 32 + Pad32 (inclLen);
+  memcpy (trailer + padding, &length, 4);
+  Output (trailer, padding + 4);
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t timestamp, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << p);
+  uint32_t inclLen = WritePacketHeader (interface, timestamp, p->GetSize ());
+  Output (p, inclLen);
+  WritePacketTrailer (inclLen);
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t timestamp, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << &header << p);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t inclLen = WritePacketHeader (interface, timestamp, headerSize + p->GetSize ());
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  uint8_t *headerData = new uint8_t [toCopy];
+  headerBuffer.CopyData (headerData, toCopy);
+  Output (headerData, toCopy);
+  delete [] headerData;
+  Output (p, inclLen - toCopy);
+  WritePacketTrailer (inclLen);
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t timestamp, uint8_t const *data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << &data << totalLen);
+  uint32_t inclLen = WritePacketHeader (interface, timestamp, totalLen);
+  Output (data, inclLen);
+  WritePacketTrailer (inclLen);
+}
+
+} // namespace ns3
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+class AsyncFileWriter;
+
+/**
+ * \brief A pcapng file holding the packets of many interfaces
+ *
+ * A pcapng file starts with a Section Header Block, and describes every
+ * capture interface with an Interface Description Block. Each packet is
+ * then stored in an Enhanced Packet Block which names its interface, so
+ * that the packets of all the devices of a simulation can be written in
+ * order into a single file, with a single stream and a single buffer.
+ *
+ * The blocks are written in the byte order of the host, which readers
+ * detect from the byte-order magic of the section header.
+ */
+class PcapngFile : public SimpleRefCount<PcapngFile>
+{
+public:
+  static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+
+  PcapngFile ();
+  ~PcapngFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying stream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file and write its section header.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * Close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * Write the blocks of this file from a background thread.
+   *
+   * The pending blocks are written on Close, and on a fatal error.
+   *
+   * \param blockSize the size of the in-memory blocks, in bytes
+   * \param maxBlocks the maximum number of in-memory blocks, at least 2
+   *
+   * \see PcapFile::EnableAsyncWrite
+   */
+  void EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks);
+
+  /**
+   * Write all the blocks written so far to the file.
+   */
+  void Flush (void);
+
+  /**
+   * Describe a new capture interface.
+   *
+   * \param dataLinkType the data link type of the packets of the interface
+   * \param snapLen the maximum size of the packets stored for the interface
+   * \param name the name of the interface, empty for none
+   * \param nanosecMode true if the timestamps of the interface are in
+   *        nanoseconds, false if they are in microseconds
+   * \returns the identifier of the interface
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen,
+                         std::string const &name, bool nanosecMode);
+
+  /**
+   * \returns the number of interfaces described so far
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write a packet of an interface.
+   *
+   * \param interface the interface identifier
+   * \param timestamp the packet timestamp, in the unit of the interface
+   * \param p the packet
+   */
+  void Write (uint32_t interface, uint64_t timestamp, Ptr<const Packet> p);
+
+  /**
+   * \brief Write a packet of an interface, preceded by a header.
+   *
+   * \param interface the interface identifier
+   * \param timestamp the packet timestamp, in the unit of the interface
+   * \param header the header
+   * \param p the packet
+   */
+  void Write (uint32_t interface, uint64_t timestamp, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Write raw packet data of an interface.
+   *
+   * \param interface the interface identifier
+   * \param timestamp the packet timestamp, in the unit of the interface
+   * \param data the packet data
+   * \param totalLen the packet length
+   */
+  void Write (uint32_t interface, uint64_t timestamp, uint8_t const *data, uint32_t totalLen);
+
+private:
+  /**
+   * \brief Write the header of an Enhanced Packet Block.
+   *
+   * \param interface the interface identifier
+   * \param timestamp the packet timestamp
+   * \param totalLen the packet length
+   * \returns the number of packet bytes to store
+   */
+  uint32_t WritePacketHeader (uint32_t interface, uint64_t timestamp, uint32_t totalLen);
+  /**
+   * \brief Write the padding and the trailer of an Enhanced Packet Block.
+   *
+   * \param inclLen the number of packet bytes stored
+   */
+  void WritePacketTrailer (uint32_t inclLen);
+  /**
+   * \brief Write bytes, directly or through the writer thread.
+   *
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void Output (const uint8_t *data, uint32_t size);
+  /**
+   * \brief Write the first bytes of a packet.
+   *
+   * \param p the packet
+   * \param size the number of bytes
+   */
+  void Output (Ptr<const Packet> p, uint32_t size);
+
+  std::ofstream m_file;              //!< the file
+  AsyncFileWriter *m_writer;         //!< the background writer, 0 to write synchronously
+  std::vector<uint32_t> m_snapLens;  //!< the snap length of every interface
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
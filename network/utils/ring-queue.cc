@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <utility>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ring-queue.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RingQueue");
+
+NS_OBJECT_ENSURE_REGISTERED (RingQueue);
+
+TypeId RingQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RingQueue")
+    .SetParent<Queue> ()
+    .SetGroupName ("Network")
+    .AddConstructor<RingQueue> ()
+    .AddAttribute ("Capacity",
+                   "The number of slots of the ring, rounded up to a power of two.",
+                   UintegerValue (128),
+                   MakeUintegerAccessor (&RingQueue::SetCapacity,
+                                         &RingQueue::GetCapacity),
+                   MakeUintegerChecker<uint32_t> (1, 0x80000000))
+  ;
+  return tid;
+}
+
+RingQueue::RingQueue () :
+  Queue (),
+  m_slots (),
+  m_mask (0),
+  m_head (0),
+  m_tail (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RingQueue::~RingQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RingQueue::SetCapacity (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  NS_ABORT_MSG_IF (GetNPackets () != 0,
+                   "Cannot change the capacity of a queue with packets.");
+
+  uint32_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_slots.assign (size, Ptr<QueueItem> ());
+  m_mask = size - 1;
+  m_head = 0;
+  m_tail = 0;
+}
+
+uint32_t
+RingQueue::GetCapacity (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_slots.size ();
+}
+
+bool
+RingQueue::DoEnqueue (Ptr<QueueItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  NS_ASSERT (m_tail - m_head == GetNPackets ());
+
+  if (m_tail - m_head == m_slots.size ())
+    {
+      NS_LOG_LOGIC ("Ring full -- dropping pkt");
+      Drop (item);
+      return false;
+    }
+
+  m_slots[m_tail & m_mask] = item;
+  m_tail++;
+
+  return true;
+}
+
+Ptr<QueueItem>
+RingQueue::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_tail - m_head == GetNPackets ());
+
+  Ptr<QueueItem> item;
+  std::swap (item, m_slots[m_head & m_mask]);
+  m_head++;
+
+  NS_LOG_LOGIC ("Popped " << item);
+
+  return item;
+}
+
+Ptr<QueueItem>
+RingQueue::DoRemove (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_tail - m_head == GetNPackets ());
+
+  Ptr<QueueItem> item;
+  std::swap (item, m_slots[m_head & m_mask]);
+  m_head++;
+
+  NS_LOG_LOGIC ("Removed " << item);
+
+  return item;
+}
+
+Ptr<const QueueItem>
+RingQueue::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_tail - m_head == GetNPackets ());
+
+  return m_slots[m_head & m_mask];
+}
+
+} // namespace ns3
@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <vector>
+#include "ns3/queue.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue stored in a fixed-capacity ring buffer
+ *
+ * The items are stored in a preallocated array of slots whose size is a
+ * power of two, so that enqueue and dequeue operations never allocate
+ * memory. The array is allocated when the Capacity attribute is set.
+ * Packets are dropped at the tail when the ring is full, in addition to
+ * the limits enforced by the Queue base class.
+ */
+class RingQueue : public Queue
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief RingQueue Constructor
+   */
+  RingQueue ();
+
+  virtual ~RingQueue ();
+
+  /**
+   * \brief Set the number of slots of the ring
+   *
+   * The capacity is rounded up to the next power of two. It can only be
+   * changed while the queue is empty.
+   *
+   * \param capacity the minimum number of slots
+   */
+  void SetCapacity (uint32_t capacity);
+  /**
+   * \return the number of slots of the ring
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueItem> item);
+  virtual Ptr<QueueItem> DoDequeue (void);
+  virtual Ptr<QueueItem> DoRemove (void);
+  virtual Ptr<const QueueItem> DoPeek (void) const;
+
+  std::vector<Ptr<QueueItem> > m_slots; //!< the ring of slots
+  uint32_t m_mask;                      //!< number of slots minus one
+  uint32_t m_head;                      //!< index of the next item to dequeue
+  uint32_t m_tail;                      //!< index of the next free slot
+};
+
+} // namespace ns3
+
+#endif /* RING_QUEUE_H */
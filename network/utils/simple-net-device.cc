@@ -19,6 +19,8 @@
  */
 #include "simple-net-device.h"
 #include "simple-channel.h"
+#include "lwsn-hop-tag.h"
+#include "lwsn-send-time-tag.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
@@ -26,6 +28,7 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
@@ -206,6 +209,13 @@ SimpleNetDevice::GetTypeId (void)
                    StringValue ("ns3::DropTailQueue"),
                    MakePointerAccessor (&SimpleNetDevice::m_queue),
                    MakePointerChecker<Queue> ())
+    .AddAttribute ("TxQueueLimits",
+                   "The queue limits (e.g., ns3::DynamicQueueLimits) applied to the bytes "
+                   "queued in the device. If not set, the device never stops the upper layer.",
+                   PointerValue (),
+                   MakePointerAccessor (&SimpleNetDevice::SetTxQueueLimits,
+                                        &SimpleNetDevice::GetTxQueueLimits),
+                   MakePointerChecker<QueueLimits> ())
     .AddAttribute ("DataRate",
                    "The default data rate for point to point links. Zero means infinite",
                    DataRateValue (DataRate ("0b/s")),
@@ -221,6 +231,13 @@ SimpleNetDevice::GetTypeId (void)
                    StringValue ("ns3::DropTailQueue"),
                    MakePointerAccessor (&SimpleNetDevice::r_queue),
                    MakePointerChecker<Queue> ())
+    .AddAttribute ("Headroom",
+                   "The number of header bytes reserved in front of the packets "
+                   "originated or forwarded by the device, so that adding the "
+                   "link headers does not reallocate their buffer.",
+                   UintegerValue (20), // LwsnHeader::GetSerializedSize
+                   MakeUintegerAccessor (&SimpleNetDevice::m_headroom),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -230,7 +247,8 @@ SimpleNetDevice::SimpleNetDevice ()
     m_node (0),
     m_mtu (0xffff),
     m_ifIndex (0),
-    m_linkUp (false)
+    m_linkUp (false),
+    m_txQueue (Create<NetDeviceQueue> ())
 {
   NS_LOG_FUNCTION (this);
   flag=0;
@@ -250,6 +268,12 @@ SimpleNetDevice::GetGid()
   return m_gid;
 }
 void
+SimpleNetDevice::SetDeliveryWriter (Ptr<LwsnDeliveryWriter> writer)
+{
+  NS_LOG_FUNCTION (this << writer);
+  m_deliveryWriter = writer;
+}
+void
 SimpleNetDevice::SetSid(uint16_t sid)
 {
   m_sid=sid;
@@ -287,6 +311,19 @@ SimpleNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol,
       LwsnHeader tempHeader;
       packet->PeekHeader(tempHeader);
 
+      if(m_gid>0 && m_deliveryWriter != 0)
+      {
+        LwsnHopTag hopTag;
+        packet->PeekPacketTag (hopTag);
+        // the start time of the header only holds whole seconds
+        LwsnSendTimeTag sendTimeTag;
+        Time sent = packet->PeekPacketTag (sendTimeTag) ? sendTimeTag.GetSendTime ()
+                                                        : Seconds (tempHeader.GetStartTime ());
+        Time now = Simulator::Now ();
+        m_deliveryWriter->Write (now, tempHeader.GetOsid (), tempHeader.GetDid (), m_gid,
+                                 hopTag.GetForwards () + 1, now - sent);
+        return;
+      }
       if(m_gid>0)
       {
         uint16_t time=Simulator::Now().GetSeconds()-tempHeader.GetStartTime();
@@ -367,6 +404,69 @@ SimpleNetDevice::SetQueue (Ptr<Queue> q)
   m_queue = q;
 }
 
+void
+SimpleNetDevice::SetTxQueueLimits (Ptr<QueueLimits> ql)
+{
+  NS_LOG_FUNCTION (this << ql);
+  m_txQueue->SetQueueLimits (ql);
+}
+
+Ptr<QueueLimits>
+SimpleNetDevice::GetTxQueueLimits (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_txQueue->GetQueueLimits ();
+}
+
+Ptr<NetDeviceQueue>
+SimpleNetDevice::GetTxQueue (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_txQueue;
+}
+
+uint32_t
+SimpleNetDevice::GetHeadroom (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_headroom;
+}
+
+void
+SimpleNetDevice::SetTxWakeCallback (NetDeviceQueue::WakeCallback cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  m_txQueue->SetWakeCallback (cb);
+}
+
+bool
+SimpleNetDevice::EnqueueTx (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  if (!m_queue->Enqueue (Create<QueueItem> (packet)))
+    {
+      return false;
+    }
+  // stops the transmission queue if the queue limits have no room left
+  m_txQueue->NotifyQueuedBytes (packet->GetSize ());
+  return true;
+}
+
+Ptr<Packet>
+SimpleNetDevice::DequeueTx (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t dropped = m_queue->GetTotalDroppedBytes ();
+  Ptr<QueueItem> item = m_queue->Dequeue ();
+  // the packets dropped from the head of the queue will never be sent
+  m_txQueue->NotifyTransmittedBytes (m_queue->GetTotalDroppedBytes () - dropped);
+  if (item == 0)
+    {
+      return 0;
+    }
+  return item->GetPacket ();
+}
+
 void
 SimpleNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 {
@@ -510,6 +610,8 @@ SimpleNetDevice::ChannelSend(Ptr<Packet> p, uint16_t protocol){
         NS_LOG_FUNCTION("Sid"<<m_sid);
         m_channel->Send(p, protocol, r_address, m_address, this);
         m_channel->Send(p, protocol, l_address, m_address, this);
+        // the slot is over for this packet; wakes the upper layer if it was held back
+        m_txQueue->NotifyTransmittedBytes (p->GetSize ());
         Simulator::Schedule(Seconds(0.9),&SimpleNetDevice::SetSleep,this);
 }
 void
@@ -545,12 +647,18 @@ SimpleNetDevice::Forwarding(Ptr<Packet> p){
     LwsnHeader tempHeader;
     packet->RemoveHeader(tempHeader);
 
+    LwsnHopTag hopTag;
+    packet->RemovePacketTag (hopTag);
+    hopTag.SetForwards (hopTag.GetForwards () + 1);
+    packet->AddPacketTag (hopTag);
+
     LwsnHeader forwardingheader;
     forwardingheader.SetOsid(tempHeader.GetOsid());
     forwardingheader.SetDid(tempHeader.GetDid());
     forwardingheader.SetType(LwsnHeader::FORWARDING);
     forwardingheader.SetStartTime(tempHeader.GetStartTime());
 
+    packet->ReserveHeadroom(m_headroom);
     packet->AddHeader(forwardingheader);
     OriginalTransmission(packet,true);
 /*
@@ -613,9 +721,13 @@ SimpleNetDevice::Forwarding(Ptr<Packet> p){
 
 }
 
-void
+bool
 SimpleNetDevice::OriginalTransmission(Ptr<Packet> p,bool header){
   //NS_LOG_FUNCTION("Sid : "<<m_sid);
+  if(!header && m_txQueue->IsStopped ()){
+    // back-pressure: leave the new packet to the upper layer
+    return false;
+  }
   Ptr<Packet> packet = p->Copy ();
   LwsnHeader sendheader;
   LwsnHeader tempHeader;
@@ -633,26 +745,31 @@ SimpleNetDevice::OriginalTransmission(Ptr<Packet> p,bool header){
     sendheader.SetDid(ndid++);
     sendheader.SetType(LwsnHeader::ORIGINAL_TRANSMISSION);
     sendheader.SetStartTime(Simulator::Now().GetSeconds());
+    LwsnSendTimeTag sendTimeTag;
+    packet->RemovePacketTag (sendTimeTag);
+    sendTimeTag.SetSendTime (Simulator::Now ());
+    packet->AddPacketTag (sendTimeTag);
   }
   int protocolNumber = 0;
+  packet->ReserveHeadroom(m_headroom);
   packet->AddHeader(sendheader);
 
   if(send_flag){
     NS_LOG_FUNCTION("-------------Sid : "<<m_sid<<"   sending~~");
     if(TransmitCompleteEvent.IsRunning()){
-      m_queue->Enqueue (Create<QueueItem> (packet));
+      return EnqueueTx (packet);
     }
     else{
      Simulator::Schedule(Seconds(1.0),&SimpleNetDevice::OriginalTransmission,this,packet,true); 
     }
-    return;
+    return true;
   }
-    if (m_queue->Enqueue (Create<QueueItem> (packet)))
+    if (EnqueueTx (packet))
       {
           if(m_queue->GetNPackets()==1 && !TransmitCompleteEvent.IsRunning ()){
             send_flag = true;
 
-            p = m_queue->Dequeue()->GetPacket ();
+            p = DequeueTx ();
             Time txTime = Time (0);
             if (m_bps > DataRate (0))
               {
@@ -718,10 +835,10 @@ SimpleNetDevice::OriginalTransmission(Ptr<Packet> p,bool header){
           else{
             NS_LOG_FUNCTION("Sid "<<m_sid << "~~~~~~~~~~~~~~~~");
           }
-        return ;
+        return true;
       }
 
-  return ;
+  return false;
    
 }
 
@@ -736,6 +853,11 @@ SimpleNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
 bool
 SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address& dest, uint16_t protocolNumber)
 {
+  if (m_txQueue->IsStopped ())
+    {
+      NS_LOG_LOGIC ("Transmission queue stopped by the queue limits");
+      return false;
+    }
 
   Ptr<Packet> packet = p->Copy ();
   LwsnHeader sendheader;
@@ -754,16 +876,21 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
     sendheader.SetDid(ndid++);
     sendheader.SetType(LwsnHeader::ORIGINAL_TRANSMISSION);
     sendheader.SetStartTime(Simulator::Now().GetSeconds());
+    LwsnSendTimeTag sendTimeTag;
+    packet->RemovePacketTag (sendTimeTag);
+    sendTimeTag.SetSendTime (Simulator::Now ());
+    packet->AddPacketTag (sendTimeTag);
   }
 
+  packet->ReserveHeadroom(m_headroom);
   packet->AddHeader(sendheader);
 
-    if (m_queue->Enqueue (Create<QueueItem> (packet)))
+    if (EnqueueTx (packet))
       {
         if(m_queue->GetNPackets()==1 && !TransmitCompleteEvent.IsRunning ()){
           send_flag = true;
 
-          p = m_queue->Dequeue()->GetPacket ();
+          p = DequeueTx ();
           Time txTime = Time (0);
           if (m_bps > DataRate (0))
             {
@@ -828,7 +955,7 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
       return true;
     }
 
-  return true ;
+  return false;
    
 }
 
@@ -842,8 +969,13 @@ SimpleNetDevice::TransmitComplete ()
       return;
     }
   NS_LOG_FUNCTION ("Sid"<<this->GetSid() <<"TransmitComplete");
+  Ptr<Packet> packet = DequeueTx ();
+  if (packet == 0)
+    {
+      // every packet left has been dropped by the queue
+      return;
+    }
   send_flag = true;
-  Ptr<Packet> packet = m_queue->Dequeue ()->GetPacket ();
 
   int delay=Simulator::Now().GetSeconds();
   NS_LOG_FUNCTION(" time now : "<<Simulator::Now().GetSeconds() << "Delay : "<<delay );
@@ -956,7 +1088,14 @@ SimpleNetDevice::DoDispose (void)
   m_channel = 0;
   m_node = 0;
   m_receiveErrorModel = 0;
+  m_deliveryWriter = 0;
   m_queue->DequeueAll ();
+  // the bytes flushed will never be completed
+  if (m_txQueue->GetQueueLimits () != 0)
+    {
+      m_txQueue->GetQueueLimits ()->Reset ();
+    }
+  m_txQueue = 0;
   if (TransmitCompleteEvent.IsRunning ())
     {
       TransmitCompleteEvent.Cancel ();
@@ -29,8 +29,10 @@
 #include "ns3/data-rate.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
+#include "ns3/queue-limits.h"
 
 #include "mac48-address.h"
+#include "lwsn-delivery-store.h"
 
 namespace ns3 {
 
@@ -97,6 +99,48 @@ public:
    */
   Ptr<Queue> GetQueue (void) const;
 
+  /**
+   * Attach a QueueLimits object (e.g., DynamicQueueLimits) to the device
+   * transmission queue. When set, the bytes handed to the device are
+   * accounted as queued when they enter the transmit queue and as completed
+   * when they are sent in their slot, and Send/SendFrom return false while
+   * the limits report no room, so that packets wait (and can be coalesced)
+   * in the upper layer instead of inside the MAC.
+   *
+   * \param ql Ptr to the queue limits, or 0 to disable byte queue limits.
+   */
+  void SetTxQueueLimits (Ptr<QueueLimits> ql);
+
+  /**
+   * \returns Ptr to the queue limits of the device transmission queue.
+   */
+  Ptr<QueueLimits> GetTxQueueLimits (void) const;
+
+  /**
+   * Get the device transmission queue, which keeps the stopped/started
+   * state of the device towards the upper layer.
+   *
+   * \returns Ptr to the device transmission queue.
+   */
+  Ptr<NetDeviceQueue> GetTxQueue (void) const;
+
+  /**
+   * Set the callback invoked when the device transmission queue, stopped
+   * because of the queue limits, has room again for new packets.
+   *
+   * \param cb the wake callback
+   */
+  void SetTxWakeCallback (NetDeviceQueue::WakeCallback cb);
+
+  /**
+   * Get the number of header bytes the device reserves in front of the
+   * packets it sends. Applications can allocate their packets with this
+   * headroom so that the device never has to reallocate them.
+   *
+   * \returns the headroom in bytes
+   */
+  uint32_t GetHeadroom (void) const;
+
   /**
    * Attach a receive ErrorModel to the SimpleNetDevice.
    *
@@ -130,9 +174,16 @@ public:
   virtual void ChannelSend(Ptr<Packet> p, uint16_t protocol);
   virtual void SetGid(uint16_t gid);
   virtual uint16_t GetGid();
+  /**
+   * Record the packets delivered to this gateway in a file, instead of
+   * logging them.
+   *
+   * \param writer the delivery file, 0 to log the deliveries
+   */
+  void SetDeliveryWriter (Ptr<LwsnDeliveryWriter> writer);
   virtual void SetSid(uint16_t Sid);
   virtual uint16_t GetSid();
-  virtual void OriginalTransmission(Ptr <Packet> p,bool header);
+  virtual bool OriginalTransmission(Ptr <Packet> p,bool header);
   virtual void SetSideAddress(Address laddress, Address raddress);
   virtual Mac48Address GetLeftAddress();
   virtual Mac48Address GetRightAddress();
@@ -154,6 +205,23 @@ public:
 protected:
   virtual void DoDispose (void);
 private:
+  /**
+   * Store a packet in the transmit queue and account for its bytes in the
+   * device transmission queue limits.
+   *
+   * \param packet the packet to enqueue
+   * \return true if the packet has been enqueued
+   */
+  bool EnqueueTx (Ptr<Packet> packet);
+  /**
+   * Dequeue a packet from the transmit queue. The bytes of the packets
+   * dropped by the queue meanwhile are reported as completed to the
+   * device transmission queue limits, since they will never be sent.
+   *
+   * \return the packet, or 0 if the queue dropped every packet left
+   */
+  Ptr<Packet> DequeueTx (void);
+
   Ptr<SimpleChannel> m_channel; //!< the channel the device is connected to
   NetDevice::ReceiveCallback m_rxCallback; //!< Receive callback
   NetDevice::PromiscReceiveCallback m_promiscCallback; //!< Promiscuous receive callback
@@ -165,6 +233,7 @@ private:
 //
   uint16_t m_gid;
   uint16_t m_sid;
+  Ptr<LwsnDeliveryWriter> m_deliveryWriter; //!< the delivery file of a gateway, 0 if none
   Ptr<Queue> r_queue;
   Mac48Address l_address;
   Mac48Address r_address;
@@ -196,7 +265,9 @@ private:
   bool m_pointToPointMode;
 
   Ptr<Queue> m_queue; //!< The Queue for outgoing packets.
+  Ptr<NetDeviceQueue> m_txQueue; //!< The device transmission queue (flow control towards the upper layer)
   DataRate m_bps; //!< The device nominal Data rate. Zero means infinite
+  uint32_t m_headroom; //!< Header bytes reserved in front of sent packets
   EventId TransmitCompleteEvent; //!< the Tx Complete event
 
   /**
@@ -207,4 +278,4 @@ private:
 
 } // namespace ns3
 
-#endif /* SIMPLE_NET_DEVICE_H */
\ No newline at end of file
+#endif /* SIMPLE_NET_DEVICE_H */
\ No newline at end of file
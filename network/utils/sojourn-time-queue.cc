@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "sojourn-time-queue.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SojournTimeQueue");
+
+NS_OBJECT_ENSURE_REGISTERED (SojournTimeQueue);
+
+TypeId SojournTimeQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SojournTimeQueue")
+    .SetParent<Queue> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SojournTimeQueue> ()
+    .AddAttribute ("FrameDuration",
+                   "The duration of a TDMA frame, i.e., a full round of slots.",
+                   TimeValue (Seconds (3.0)),
+                   MakeTimeAccessor (&SojournTimeQueue::m_frameDuration),
+                   MakeTimeChecker ())
+    .AddAttribute ("TargetFrames",
+                   "The target sojourn time, in TDMA frames.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&SojournTimeQueue::m_targetFrames),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("IntervalFrames",
+                   "The interval the sojourn time must stay above target before dropping, in TDMA frames.",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&SojournTimeQueue::m_intervalFrames),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinBytes",
+                   "Never drop while the queue holds no more than this amount of bytes.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&SojournTimeQueue::m_minBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Count",
+                     "Number of drops since entering the dropping state",
+                     MakeTraceSourceAccessor (&SojournTimeQueue::m_count),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("DropState",
+                     "Whether the queue is in the dropping state",
+                     MakeTraceSourceAccessor (&SojournTimeQueue::m_dropping),
+                     "ns3::TracedValueCallback::Bool")
+    .AddTraceSource ("DropNext",
+                     "Time of the next drop while in the dropping state",
+                     MakeTraceSourceAccessor (&SojournTimeQueue::m_dropNext),
+                     "ns3::TracedValueCallback::Time")
+    .AddTraceSource ("Sojourn",
+                     "Sojourn time of the last packet dequeued",
+                     MakeTraceSourceAccessor (&SojournTimeQueue::m_traceSojourn),
+                     "ns3::SojournTimeQueue::SojournTracedCallback")
+  ;
+  return tid;
+}
+
+SojournTimeQueue::SojournTimeQueue () :
+  Queue (),
+  m_packets (),
+  m_count (0),
+  m_dropping (false),
+  m_dropNext (Seconds (0)),
+  m_firstAboveTime (Seconds (0)),
+  m_lastCount (0),
+  m_dropSojourn (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SojournTimeQueue::~SojournTimeQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Time
+SojournTimeQueue::GetTarget (void) const
+{
+  return Seconds (m_frameDuration.GetSeconds () * m_targetFrames);
+}
+
+Time
+SojournTimeQueue::GetInterval (void) const
+{
+  return Seconds (m_frameDuration.GetSeconds () * m_intervalFrames);
+}
+
+uint32_t
+SojournTimeQueue::GetDropSojourn (void) const
+{
+  return m_dropSojourn;
+}
+
+bool
+SojournTimeQueue::DoEnqueue (Ptr<QueueItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  NS_ASSERT (m_packets.size () == GetNPackets ());
+
+  Entry entry;
+  entry.item = item;
+  entry.tstamp = Simulator::Now ();
+  m_packets.push (entry);
+
+  return true;
+}
+
+Time
+SojournTimeQueue::ControlLaw (Time t) const
+{
+  return t + Seconds (GetInterval ().GetSeconds () / std::sqrt (static_cast<double> (m_count.Get ())));
+}
+
+bool
+SojournTimeQueue::OkToDrop (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+
+  if (m_packets.empty ())
+    {
+      m_firstAboveTime = Seconds (0);
+      return false;
+    }
+
+  const Entry &head = m_packets.front ();
+  Time sojourn = now - head.tstamp;
+
+  if (sojourn < GetTarget () || GetNBytes () - head.item->GetPacketSize () <= m_minBytes)
+    {
+      // went below target, or too few packets to keep a standing queue
+      m_firstAboveTime = Seconds (0);
+      return false;
+    }
+  if (m_firstAboveTime == Seconds (0))
+    {
+      // just went above target; give the queue an interval to drain
+      m_firstAboveTime = now + GetInterval ();
+      return false;
+    }
+  return now >= m_firstAboveTime;
+}
+
+void
+SojournTimeQueue::DropHead (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("Sojourn time above target -- dropping head pkt");
+
+  // Remove () updates the statistics of the base class and fires the Drop trace
+  Remove ();
+  m_dropSojourn++;
+}
+
+Ptr<QueueItem>
+SojournTimeQueue::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_packets.size () == GetNPackets ());
+
+  Time now = Simulator::Now ();
+  bool okToDrop = OkToDrop (now);
+
+  if (m_dropping)
+    {
+      if (!okToDrop)
+        {
+          // sojourn time went below target, leave the dropping state
+          m_dropping = false;
+        }
+      while (m_dropping && now >= m_dropNext.Get ())
+        {
+          DropHead ();
+          ++m_count;
+          if (!OkToDrop (now))
+            {
+              m_dropping = false;
+            }
+          else
+            {
+              m_dropNext = ControlLaw (m_dropNext.Get ());
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      DropHead ();
+      OkToDrop (now);
+      m_dropping = true;
+      // if we left the dropping state recently, resume from the previous drop rate
+      uint32_t delta = m_count.Get () - m_lastCount;
+      if (delta > 1 && now - m_dropNext.Get () < Seconds (16 * GetInterval ().GetSeconds ()))
+        {
+          m_count = delta;
+        }
+      else
+        {
+          m_count = 1;
+        }
+      m_lastCount = m_count.Get ();
+      m_dropNext = ControlLaw (now);
+    }
+
+  if (m_packets.empty ())
+    {
+      NS_LOG_LOGIC ("Queue emptied by sojourn drops");
+      return 0;
+    }
+
+  Entry entry = m_packets.front ();
+  m_packets.pop ();
+
+  NS_LOG_LOGIC ("Popped " << entry.item);
+  m_traceSojourn (now - entry.tstamp);
+
+  return entry.item;
+}
+
+Ptr<QueueItem>
+SojournTimeQueue::DoRemove (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_packets.size () == GetNPackets ());
+
+  Ptr<QueueItem> item = m_packets.front ().item;
+  m_packets.pop ();
+
+  NS_LOG_LOGIC ("Removed " << item);
+
+  return item;
+}
+
+Ptr<const QueueItem>
+SojournTimeQueue::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_packets.size () == GetNPackets ());
+
+  return m_packets.front ().item;
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SOJOURN_TIME_QUEUE_H
+#define SOJOURN_TIME_QUEUE_H
+
+#include <queue>
+#include "ns3/queue.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops packets based on their sojourn time
+ *
+ * Every item is timestamped when it is stored by DoEnqueue. When an item
+ * is pulled from the head of the queue, its sojourn time is compared with
+ * the target delay following the CoDel control law: once the sojourn time
+ * has stayed above the target for a whole interval, the queue enters the
+ * dropping state and drops head packets at intervals that shrink with the
+ * inverse square root of the number of drops, until the sojourn time falls
+ * below the target again.
+ *
+ * Target and interval are expressed in TDMA frames, so that the same
+ * configuration holds whatever the slot length of the device is. The frame
+ * duration defaults to the three one-second slots used by SimpleNetDevice.
+ *
+ * The tail-drop limit enforced by the Queue base class still applies.
+ */
+class SojournTimeQueue : public Queue
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief SojournTimeQueue Constructor
+   */
+  SojournTimeQueue ();
+
+  virtual ~SojournTimeQueue ();
+
+  /**
+   * \return the target sojourn time, i.e., TargetFrames TDMA frames
+   */
+  Time GetTarget (void) const;
+  /**
+   * \return the control interval, i.e., IntervalFrames TDMA frames
+   */
+  Time GetInterval (void) const;
+  /**
+   * \return the number of packets dropped because of their sojourn time
+   */
+  uint32_t GetDropSojourn (void) const;
+
+  /**
+   * TracedCallback signature for the sojourn time of a dequeued packet.
+   *
+   * \param [in] sojourn The time the packet spent in the queue.
+   */
+  typedef void (* SojournTracedCallback)(Time sojourn);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueItem> item);
+  virtual Ptr<QueueItem> DoDequeue (void);
+  virtual Ptr<QueueItem> DoRemove (void);
+  virtual Ptr<const QueueItem> DoPeek (void) const;
+
+  /**
+   * \brief Check whether the head packet may be dropped
+   * \param now the current time
+   * \return true if the sojourn time has been above target for an interval
+   */
+  bool OkToDrop (Time now);
+  /**
+   * \brief Drop the head packet because of its sojourn time
+   */
+  void DropHead (void);
+  /**
+   * \brief Compute the time of the next drop according to the control law
+   * \param t the reference time
+   * \return the time of the next drop
+   */
+  Time ControlLaw (Time t) const;
+
+  /// A stored item along with the time it entered the queue
+  struct Entry
+  {
+    Ptr<QueueItem> item;  //!< the queued item
+    Time tstamp;          //!< enqueue time
+  };
+
+  std::queue<Entry> m_packets;         //!< the items in the queue
+
+  Time m_frameDuration;                //!< duration of a TDMA frame
+  double m_targetFrames;               //!< target sojourn time, in frames
+  double m_intervalFrames;             //!< control interval, in frames
+  uint32_t m_minBytes;                 //!< do not drop while the queue holds no more than this
+
+  TracedValue<uint32_t> m_count;       //!< number of drops since entering the dropping state
+  TracedValue<bool> m_dropping;        //!< true if in the dropping state
+  TracedValue<Time> m_dropNext;        //!< time of the next drop while dropping
+  Time m_firstAboveTime;               //!< time at which the sojourn time will have been above target for an interval
+  uint32_t m_lastCount;                //!< value of m_count when the dropping state was last left
+  uint32_t m_dropSojourn;              //!< packets dropped because of their sojourn time
+
+  TracedCallback<Time> m_traceSojourn; //!< sojourn time of every dequeued packet
+};
+
+} // namespace ns3
+
+#endif /* SOJOURN_TIME_QUEUE_H */
@@ -10,6 +10,8 @@
 #include <ns3/callback.h>
 #include <ns3/object.h>
 #include <ns3/lwsn-header.h>
+#include <ns3/lwsn-sensor-application.h>
+#include <ns3/lwsn-delivery-store.h>
 
 #include <string>
 #include <iostream>
@@ -18,8 +20,26 @@
 using namespace ns3;
 
 
-int main(void)
+int main(int argc, char *argv[])
 {
+    uint16_t numSensor=6;
+    double maxTime = 10.0;
+    int number = 10;  // readings expected from the whole network
+    uint32_t packetSize = 100;
+    uint32_t seed = 10;
+    // the gateways record their deliveries in a columnar file, which
+    // LwsnDeliveryReader or numpy.memmap load without parsing any log
+    std::string results = "";
+
+    CommandLine cmd;
+    cmd.AddValue ("sensors", "the number of sensors between the two gateways", numSensor);
+    cmd.AddValue ("time", "the time the sensors stop sending, in seconds", maxTime);
+    cmd.AddValue ("readings", "the number of readings expected from the whole network", number);
+    cmd.AddValue ("size", "the size of the readings, in bytes", packetSize);
+    cmd.AddValue ("seed", "the seed of the random number generator", seed);
+    cmd.AddValue ("results", "the file recording the deliveries, empty to log them", results);
+    cmd.Parse (argc, argv);
+
     LogComponentEnableAll(LOG_PREFIX_TIME);
     LogComponentEnableAll(LOG_PREFIX_FUNC);
     Packet::EnablePrinting();
@@ -32,7 +52,6 @@ int main(void)
     // Node Configuration --begin 
     NodeContainer c;
     uint16_t numGateway=2;
-    uint16_t numSensor=6;
     uint16_t numNode = numGateway + numSensor;
     c.Create(numNode);
     MobilityHelper mobility;
@@ -73,6 +92,13 @@ int main(void)
     dev[0]->SetGid(1);			dev[0]->SetSid(0);
     dev[numNode-1]->SetGid(2);  dev[numNode-1]->SetSid(0);
 
+    if(!results.empty()){
+    	Ptr<LwsnDeliveryWriter> deliveries = Create<LwsnDeliveryWriter> ();
+    	NS_ABORT_MSG_UNLESS (deliveries->Open (results), "Unable to create " << results);
+    	dev[0]->SetDeliveryWriter(deliveries);
+    	dev[numNode-1]->SetDeliveryWriter(deliveries);
+    }
+
     // dev[0]->SetLowPositionInfo(0,0,0,Mac48Address("00:00:00:00:00:00"));
     // dev[0]->SetHighPositionInfo(dev[1],dev[numNode-1]->GetGid(),dev[1]->GetSid(),
     // 							Mac48Address::ConvertFrom (dev[1]->GetAddress()));
@@ -90,42 +116,19 @@ int main(void)
     // 								Mac48Address::ConvertFrom(dev[i+1]->GetAddress()));
     // }
 
-	double min = 1.0;
-	double max = 6.0;
-    RngSeedManager::SetSeed(10);
-    // RngSeedManager::SetRun(7);
-    Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
-    x->SetAttribute ("Min", DoubleValue (min));
-	x->SetAttribute ("Max", DoubleValue (max));
-
-	double minTime = 0.0;
-	double maxTime = 10.0;
-	RngSeedManager::SetSeed(10);
-
-	Ptr<UniformRandomVariable> t = CreateObject<UniformRandomVariable> ();
-	t->SetAttribute ("Min", DoubleValue (minTime));
-	t->SetAttribute ("Max", DoubleValue (maxTime));
-
-	int number = 10;
-	int randomTime[50]={0,};
-	int randomSid[50]={0,};
-	for(int i = 0; i<number ; i++){
-	  randomSid[i] = x->GetInteger();
-	}
-
-	for(int i = 0; i<number ; i++){
-	  randomTime[i] =t->GetInteger();
-	}
-
-	// int random[50]={0};
-	// for(int i=0;i<50;i++){
-	//  	random[i]=x->GetInteger();
-	//  }
-	
-	 Ptr<Packet> packet = Create<Packet> (100);
-	 for(int i=0;i<number;i++){
-	 	std::cout<<randomTime[i]<<","<<randomSid[i]<<std::endl;
-	  	Simulator::Schedule(Seconds(randomTime[i]),&SimpleNetDevice::OriginalTransmission,dev[randomSid[i]],packet,false);
+    RngSeedManager::SetSeed(seed);
+
+	// every sensor draws its next reading when the current one is sent,
+	// so the event list holds one pending reading per sensor
+	for(uint16_t i = 1; i<numNode-1; i++){
+		Ptr<LwsnSensorApplication> sensor = CreateObject<LwsnSensorApplication> ();
+		sensor->SetAttribute ("TrafficModel", EnumValue (LwsnSensorApplication::POISSON));
+		sensor->SetAttribute ("Interval", TimeValue (Seconds (maxTime*numSensor/number)));
+		sensor->SetAttribute ("PacketSize", UintegerValue (packetSize));
+		sensor->SetDevice (dev[i]);
+		sensor->AssignStreams (i);
+		sensor->SetStopTime (Seconds (maxTime));
+		c.Get(i)->AddApplication (sensor);
 	}
 
 	// for(int i = 1; i<numNode-1;i++){
@@ -134,7 +137,7 @@ int main(void)
 
 
     // Node Configuration -- end
-	RngSeedManager::SetSeed(10);
+	RngSeedManager::SetSeed(seed);
 
     Simulator::Run ();
   